@@ -0,0 +1,53 @@
+#include "nanobroker/Capture.hpp"
+#include "nanobroker/video_protocol.hpp"
+#include <iostream>
+#include <string>
+
+// Publishes a camera into the video topic without copying: the driver
+// captures straight into broker slots.
+//
+//   v4l2_producer /dev/video0 640 480        # real camera, or the vivid test driver
+//   v4l2_producer clip.yuv 640 480           # raw YUYV frames from a file at 30 FPS
+
+using VideoBroker = NanoBroker::Broker<Protocol::CameraFrame, Protocol::BUFFER_SIZE, Protocol::MAX_CONSUMERS>;
+
+template <typename Device>
+void stream(VideoBroker &broker, Device &device) {
+    NanoBroker::CaptureAdapter<Protocol::CameraFrame, Protocol::BUFFER_SIZE, Protocol::MAX_CONSUMERS, Device>
+        capture(broker, device);
+    std::cout << "[Producer] Capturing " << device.width() << "x" << device.height() << std::endl;
+
+    while (true) {
+        if (capture.poll(1000) && capture.frames() % 30 == 0) {
+            std::cout << "[Producer] Sent Frame " << capture.frames() << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: v4l2_producer <device|file.yuv> <width> <height>" << std::endl;
+        return 1;
+    }
+    std::string source = argv[1];
+    uint32_t width = std::stoi(argv[2]);
+    uint32_t height = std::stoi(argv[3]);
+
+    try {
+        NanoBroker::BrokerSettings settings;
+        settings.overflow_policy = NanoBroker::OverflowPolicy::OVERWRITE_OLD;
+        VideoBroker broker(Protocol::TOPIC_NAME, true, 0, settings);
+
+        if (source.compare(0, 5, "/dev/") == 0) {
+            NanoBroker::V4L2Device device(source, width, height, V4L2_PIX_FMT_YUYV);
+            stream(broker, device);
+        } else {
+            NanoBroker::RawFileSource device(source, width, height, 2, V4L2_PIX_FMT_YUYV, 30);
+            stream(broker, device);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
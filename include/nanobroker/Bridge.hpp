@@ -0,0 +1,376 @@
+#ifndef NANOBROKER_BRIDGE_HPP
+#define NANOBROKER_BRIDGE_HPP
+
+#include "NanoBroker.hpp"
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <vector>
+
+namespace NanoBroker {
+
+const uint32_t BRIDGE_MAGIC = 0x4E42524B; // "NBRK"
+const uint32_t BRIDGE_VERSION = 1;
+
+// Sent once by the sender after connecting.
+struct BridgeHello {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t struct_size;
+};
+
+// Precedes every message's payload on the wire.
+struct BridgeHeader {
+    uint32_t magic;
+    uint32_t bytes;       // Payload bytes that follow (payload_size() of the slot)
+    uint64_t sequence;    // Sender-side message counter, from 0
+    int64_t sent_ns;      // Sender CLOCK_MONOTONIC; only meaningful on the same host
+};
+
+namespace detail {
+
+// Payloads at least this large go out with MSG_ZEROCOPY when enabled. Below
+// it, page pinning and the completion round trip cost more than the copy.
+const size_t ZEROCOPY_THRESHOLD = 64 * 1024;
+
+// Endpoints are "tcp:host:port" or "unix:/path/to/socket".
+inline int open_endpoint(const std::string &endpoint, bool listen_side) {
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        std::string path = endpoint.substr(5);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path too long: " + path);
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd == -1) throw std::runtime_error("socket() failed");
+        if (listen_side) {
+            ::unlink(path.c_str());
+            if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1 || listen(fd, 1) == -1) {
+                ::close(fd);
+                throw std::runtime_error("Cannot listen on " + endpoint + ": " + std::strerror(errno));
+            }
+        } else if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
+            ::close(fd);
+            throw std::runtime_error("Cannot connect to " + endpoint + ": " + std::strerror(errno));
+        }
+        return fd;
+    }
+
+    if (endpoint.compare(0, 4, "tcp:") != 0) throw std::runtime_error("Endpoint must be tcp:host:port or unix:path");
+    size_t colon = endpoint.rfind(':');
+    std::string host = endpoint.substr(4, colon - 4);
+    std::string port = endpoint.substr(colon + 1);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listen_side ? AI_PASSIVE : 0;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(host.empty() || host == "*" ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0) {
+        throw std::runtime_error("Cannot resolve " + endpoint);
+    }
+
+    int fd = -1;
+    for (addrinfo *ai = result; ai && fd == -1; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd == -1) continue;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        bool ok = listen_side ? (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 1) == 0)
+                              : connect(fd, ai->ai_addr, ai->ai_addrlen) == 0;
+        if (!ok) { ::close(fd); fd = -1; }
+    }
+    freeaddrinfo(result);
+    if (fd == -1) throw std::runtime_error("Cannot " + std::string(listen_side ? "listen on " : "connect to ") + endpoint);
+    return fd;
+}
+
+inline void tune_stream_socket(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Fails harmlessly on AF_UNIX
+    int buffer = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+}
+
+} // namespace detail
+
+// Streams a topic to a socket. Attaches as an ordinary consumer and sends
+// each batch of ready slots with one sendmsg(): a header and a payload
+// iovec per slot, the payload pointing straight at slot memory, so small
+// messages share a syscall and large ones are never staged. With zerocopy
+// the kernel sends from the slot pages as well (MSG_ZEROCOPY, TCP only) and
+// the slots are released once the kernel reports it is done with them.
+template <typename T, size_t BufferSize = 30, size_t MaxConsumers = 16>
+class BridgeSender {
+    Broker<T, BufferSize, MaxConsumers> source;
+    int fd;
+    size_t max_batch;
+    bool zerocopy = false;
+    uint64_t sequence = 0;
+    uint32_t zerocopy_sent = 0;  // MSG_ZEROCOPY sendmsg() calls so far
+    uint32_t zerocopy_done = 0;  // Calls the kernel has completed
+    uint64_t torn = 0;
+    uint64_t copied = 0;         // Zerocopy sends the kernel copied anyway
+    std::vector<BridgeHeader> headers;
+    std::vector<iovec> iov;
+
+    // Sends all of iov. With a stop flag the socket is polled for room in
+    // 100 ms steps and sendmsg() never blocks, so a stalled receiver cannot
+    // hold the caller once the flag is cleared; returns false then.
+    bool send_all(int flags, const std::atomic<bool> *running = nullptr) {
+        msghdr msg{};
+        msg.msg_iov = iov.data();
+        msg.msg_iovlen = iov.size();
+        while (msg.msg_iovlen > 0) {
+            if (running) {
+                if (!*running) return false;
+                pollfd pfd{fd, POLLOUT, 0};
+                if (poll(&pfd, 1, 100) <= 0) continue;
+                // POLLERR alone under zerocopy: completions are queued but
+                // the socket is still full.
+                if (!(pfd.revents & POLLOUT) && (flags & MSG_ZEROCOPY)) {
+                    if (!wait_completions(running)) return false;
+                    continue;
+                }
+                flags |= MSG_DONTWAIT;
+            }
+            ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL | flags);
+            if (sent == -1) {
+                if (errno == EINTR || errno == EAGAIN) continue; // EAGAIN only with MSG_DONTWAIT
+                if (errno == ENOBUFS && (flags & MSG_ZEROCOPY)) {
+                    if (!wait_completions(running)) return false;
+                    continue;
+                }
+                throw std::runtime_error(std::string("Bridge send failed: ") + std::strerror(errno));
+            }
+            if (flags & MSG_ZEROCOPY) zerocopy_sent++;
+
+            // Skip what went out; partial sends leave msg_iov mid-buffer.
+            while (sent > 0) {
+                size_t n = std::min<size_t>(sent, msg.msg_iov->iov_len);
+                msg.msg_iov->iov_base = static_cast<uint8_t *>(msg.msg_iov->iov_base) + n;
+                msg.msg_iov->iov_len -= n;
+                sent -= n;
+                if (msg.msg_iov->iov_len == 0) { msg.msg_iov++; msg.msg_iovlen--; }
+            }
+        }
+        return true;
+    }
+
+    // Reads MSG_ZEROCOPY completions off the socket error queue until the
+    // kernel has finished with every zerocopy send so far. Returns false if
+    // the stop flag is cleared first.
+    bool wait_completions(const std::atomic<bool> *running = nullptr) {
+        while (static_cast<int32_t>(zerocopy_sent - zerocopy_done) > 0) {
+            if (running && !*running) return false;
+            char control[128];
+            msghdr msg{};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (recvmsg(fd, &msg, MSG_ERRQUEUE) == -1) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) throw std::runtime_error("MSG_ERRQUEUE read failed");
+                pollfd pfd{fd, 0, 0}; // POLLERR is always reported
+                poll(&pfd, 1, 100);
+                continue;
+            }
+            for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+                const sock_extended_err *err = reinterpret_cast<const sock_extended_err *>(CMSG_DATA(cm));
+                if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+                zerocopy_done = err->ee_data + 1;
+                if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) copied++;
+            }
+        }
+        return true;
+    }
+
+public:
+    BridgeSender(const std::string &topic, const std::string &endpoint, size_t batch = 64,
+                 bool use_zerocopy = false, int id = AUTO_ID, BrokerSettings settings = BrokerSettings())
+        : source(topic, false, id, settings), fd(detail::open_endpoint(endpoint, false)),
+          max_batch(std::max<size_t>(1, std::min<size_t>(batch, IOV_MAX / 2)))
+    {
+        detail::tune_stream_socket(fd);
+        if (use_zerocopy) {
+            int one = 1;
+            zerocopy = setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+            if (!zerocopy) std::cerr << "[NanoBroker] MSG_ZEROCOPY unavailable on " << endpoint << ", copying" << std::endl;
+        }
+
+        BridgeHello hello{BRIDGE_MAGIC, BRIDGE_VERSION, sizeof(T)};
+        iov.assign(1, {&hello, sizeof(hello)});
+        send_all(0);
+    }
+
+    ~BridgeSender() { ::close(fd); }
+
+    BridgeSender(const BridgeSender &) = delete;
+    BridgeSender &operator=(const BridgeSender &) = delete;
+
+    // Sends every ready slot, up to the batch size per sendmsg(). Returns
+    // messages sent. If `running` is cleared while the receiver is not
+    // keeping up, gives up mid-batch and returns 0; the stream is then cut
+    // mid-message and the sender should be closed.
+    size_t pump(const std::atomic<bool> *running = nullptr) {
+        auto batch = source.peek_batch(max_batch);
+        if (batch.empty()) return 0;
+
+        headers.resize(batch.size());
+        iov.clear();
+        size_t payload_bytes = 0;
+        for (size_t i = 0; i < batch.size(); i++) {
+            uint32_t bytes = static_cast<uint32_t>(payload_size(batch[i]));
+            headers[i] = {BRIDGE_MAGIC, bytes, sequence++, detail::now_ns()};
+            iov.push_back({&headers[i], sizeof(BridgeHeader)});
+            iov.push_back({const_cast<T *>(&batch[i]), bytes});
+            payload_bytes += bytes;
+        }
+
+        bool use_zerocopy = zerocopy && payload_bytes >= detail::ZEROCOPY_THRESHOLD;
+        if (!send_all(use_zerocopy ? MSG_ZEROCOPY : 0, running) ||
+            (use_zerocopy && !wait_completions(running))) {
+            sequence -= batch.size();
+            return 0;
+        }
+
+        // Under OVERWRITE_OLD a slot may have been rewritten while it was on
+        // its way out; the receiver has no way to know, so count it.
+        for (size_t i = 0; i < batch.size(); i++) torn += !source.batch_valid(i);
+        source.release_n(batch.size());
+        return batch.size();
+    }
+
+    // Waits on the topic according to settings.wait_strategy, then pumps.
+    size_t wait_and_pump(int64_t timeout_ms = -1, const std::atomic<bool> *running = nullptr) {
+        if (!source.wait_and_peek(timeout_ms)) return 0;
+        return pump(running);
+    }
+
+    uint64_t sent() const { return sequence; }
+    uint64_t torn_sends() const { return torn; }
+    uint64_t zerocopy_copied() const { return copied; }
+    bool zerocopy_enabled() const { return zerocopy; }
+    int id() const { return source.id(); }
+};
+
+// Accepts a BridgeSender connection and republishes its messages into a
+// local topic it creates. Large payloads are received straight into the
+// claimed slot; small ones are carved out of a read-ahead buffer so a batch
+// of them costs one recv().
+template <typename T, size_t BufferSize = 30, size_t MaxConsumers = 16>
+class BridgeReceiver {
+    Broker<T, BufferSize, MaxConsumers> sink;
+    BrokerSettings settings;
+    int listen_fd;
+    int fd = -1;
+    std::vector<uint8_t> buffer;
+    size_t buffered_begin = 0, buffered_end = 0;
+    uint64_t dropped = 0;
+    uint64_t received = 0;
+
+    // Reads exactly `bytes` into dst (or discards them if dst is null).
+    // Returns false when the sender disconnects.
+    bool read_exact(void *dst, size_t bytes) {
+        uint8_t *out = static_cast<uint8_t *>(dst);
+        while (bytes > 0) {
+            if (buffered_begin == buffered_end) {
+                if (out && bytes >= buffer.size() / 2) {
+                    ssize_t n = recv(fd, out, bytes, MSG_WAITALL);
+                    if (n <= 0) { if (n == -1 && errno == EINTR) continue; return false; }
+                    out += n;
+                    bytes -= n;
+                    continue;
+                }
+                ssize_t n = recv(fd, buffer.data(), buffer.size(), 0);
+                if (n <= 0) { if (n == -1 && errno == EINTR) continue; return false; }
+                buffered_begin = 0;
+                buffered_end = n;
+            }
+            size_t n = std::min(bytes, buffered_end - buffered_begin);
+            if (out) { std::memcpy(out, buffer.data() + buffered_begin, n); out += n; }
+            buffered_begin += n;
+            bytes -= n;
+        }
+        return true;
+    }
+
+public:
+    BridgeReceiver(const std::string &endpoint, const std::string &topic,
+                   BrokerSettings custom_settings = BrokerSettings())
+        : sink(topic, true, 0, custom_settings), settings(custom_settings),
+          listen_fd(detail::open_endpoint(endpoint, true)), buffer(256 * 1024) {}
+
+    ~BridgeReceiver() {
+        if (fd != -1) ::close(fd);
+        ::close(listen_fd);
+    }
+
+    BridgeReceiver(const BridgeReceiver &) = delete;
+    BridgeReceiver &operator=(const BridgeReceiver &) = delete;
+
+    // Waits up to timeout_ms (-1 = no limit) for a sender to connect, then
+    // completes the handshake. Returns false on timeout or when a signal
+    // interrupts the wait, so callers can check a stop flag.
+    bool accept_sender(int64_t timeout_ms = -1) {
+        pollfd pfd{listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, static_cast<int>(timeout_ms)) <= 0) return false;
+
+        if (fd != -1) ::close(fd);
+        fd = accept(listen_fd, nullptr, nullptr);
+        if (fd == -1) throw std::runtime_error("accept() failed");
+        detail::tune_stream_socket(fd);
+        buffered_begin = buffered_end = 0;
+
+        BridgeHello hello{};
+        if (!read_exact(&hello, sizeof(hello)) || hello.magic != BRIDGE_MAGIC) {
+            throw std::runtime_error("Bridge handshake failed");
+        }
+        if (hello.version != BRIDGE_VERSION) throw std::runtime_error("Bridge Version Mismatch!");
+        if (hello.struct_size != sizeof(T)) throw std::runtime_error("Data Struct Size Mismatch!");
+        return true;
+    }
+
+    // Waits up to timeout_ms for the next message (or a disconnect) to be
+    // readable, so an idle stream does not park the caller in recv().
+    bool poll_data(int64_t timeout_ms) {
+        if (buffered_begin != buffered_end) return true;
+        pollfd pfd{fd, POLLIN, 0};
+        return poll(&pfd, 1, static_cast<int>(timeout_ms)) > 0;
+    }
+
+    // Receives and publishes one message. Returns false when the sender has
+    // disconnected. A message that finds the local ring full (BLOCK) is
+    // read and dropped so the stream stays in sync.
+    bool pump() {
+        BridgeHeader header;
+        if (!read_exact(&header, sizeof(header))) return false;
+        if (header.magic != BRIDGE_MAGIC || header.bytes > sizeof(T)) throw std::runtime_error("Bridge stream corrupt");
+
+        T *slot = sink.prepare_publish(settings.producer_timeout_ms);
+        if (!read_exact(slot, header.bytes)) {
+            sink.abort_publish();
+            return false;
+        }
+        if (slot) {
+            sink.commit_publish();
+            received++;
+        } else {
+            dropped++;
+        }
+        return true;
+    }
+
+    uint64_t messages() const { return received; }
+    uint64_t drops() const { return dropped; }
+    Broker<T, BufferSize, MaxConsumers> &broker() { return sink; }
+};
+
+} // namespace NanoBroker
+#endif
@@ -0,0 +1,149 @@
+#ifndef NANOBROKER_BROKER_GROUP_HPP
+#define NANOBROKER_BROKER_GROUP_HPP
+
+#include "NanoBroker.hpp"
+#include <functional>
+#include <vector>
+
+namespace NanoBroker {
+
+namespace detail {
+
+// Layout of struct futex_waitv (Linux 5.16+), spelled out so older kernel
+// headers still compile.
+struct FutexWaitv {
+    uint64_t val;
+    uint64_t uaddr;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+const long SYS_FUTEX_WAITV = 449;     // Same number on every architecture
+const uint32_t FUTEX2_SIZE_U32 = 0x02; // Shared (not FUTEX2_PRIVATE): words live in shm
+const size_t MAX_GROUP_SOURCES = 128;   // Kernel limit on futex_waitv() entries
+
+} // namespace detail
+
+// Waits on many consumer channels at once, e.g. one fusion thread reading
+// eight camera topics. Registers as a sleeper on every channel's publish
+// word and blocks in a single futex_waitv() call, falling back to short
+// per-channel futex waits on kernels without it. Sources of any broker
+// type (Broker, ByteBroker, SpscBroker) can be mixed; the group only uses
+// has_data() and signal(), and callers keep using each broker's own
+// peek()/release().
+class BrokerGroup {
+    struct Source {
+        std::function<bool()> has_data;
+        ChannelSignal *signal;
+    };
+
+    std::vector<Source> sources;
+    std::vector<uint32_t> seen;
+    std::vector<detail::FutexWaitv> waitv;
+    size_t cursor = 0; // Round-robin start for the next scan
+    std::vector<size_t> scratch;
+    BrokerSettings settings;
+
+    static bool &waitv_supported() {
+        static bool supported = true;
+        return supported;
+    }
+
+    size_t collect(std::vector<size_t> &ready) const {
+        ready.clear();
+        for (size_t k = 0; k < sources.size(); k++) {
+            size_t i = (cursor + k) % sources.size();
+            if (sources[i].has_data()) ready.push_back(i);
+        }
+        return ready.size();
+    }
+
+    void sleep(int64_t timeout_us) {
+        if (waitv_supported()) {
+            for (size_t i = 0; i < sources.size(); i++) waitv[i].val = seen[i];
+
+            struct timespec deadline;
+            struct timespec *tsp = nullptr;
+            if (timeout_us >= 0) {
+                clock_gettime(CLOCK_MONOTONIC, &deadline);
+                int64_t ns = deadline.tv_nsec + (timeout_us % 1000000) * 1000;
+                deadline.tv_sec += timeout_us / 1000000 + ns / 1000000000;
+                deadline.tv_nsec = ns % 1000000000;
+                tsp = &deadline;
+            }
+            if (syscall(detail::SYS_FUTEX_WAITV, waitv.data(), static_cast<unsigned>(waitv.size()), 0, tsp,
+                        CLOCK_MONOTONIC) == -1 && errno == ENOSYS) {
+                waitv_supported() = false;
+            } else {
+                return;
+            }
+        }
+
+        // Fallback: sleep on each channel in turn for at most 1 ms.
+        int64_t slice = (timeout_us < 0 || timeout_us > 1000) ? 1000 : timeout_us;
+        size_t i = cursor % sources.size();
+        detail::futex_wait(&sources[i].signal->sequence, seen[i], slice);
+    }
+
+public:
+    explicit BrokerGroup(BrokerSettings custom_settings = BrokerSettings()) : settings(custom_settings) {}
+
+    // Adds a consumer-side broker; returns its index in wait() results. The
+    // broker must outlive the group.
+    template <typename B>
+    size_t add(B &broker) {
+        if (sources.size() == detail::MAX_GROUP_SOURCES) throw std::runtime_error("BrokerGroup is full");
+
+        ChannelSignal *signal = &broker.signal();
+        sources.push_back({[&broker] { return broker.has_data(); }, signal});
+        seen.push_back(0);
+        waitv.push_back({0, reinterpret_cast<uint64_t>(&signal->sequence), detail::FUTEX2_SIZE_U32, 0});
+        return sources.size() - 1;
+    }
+
+    size_t size() const { return sources.size(); }
+
+    // Blocks until at least one source has unread data, or timeout_ms (>= 0)
+    // elapses. Fills `ready` with the indices of every ready source, rotated
+    // so the scan starts one past the first source returned last time: a
+    // busy camera cannot starve the others. Returns ready.size().
+    size_t wait(std::vector<size_t> &ready, int64_t timeout_ms = -1) {
+        using Clock = std::chrono::steady_clock;
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms);
+        if (sources.empty()) { ready.clear(); return 0; }
+
+        int spin_count = 0;
+        while (!collect(ready)) {
+            if (spin_count < settings.spin_iterations) { _mm_pause(); spin_count++; continue; }
+
+            int64_t remaining_us = -1;
+            if (timeout_ms >= 0) {
+                remaining_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    deadline - Clock::now()).count();
+                if (remaining_us <= 0) return 0;
+            }
+
+            // Register everywhere, snapshot the words, then re-check so a
+            // publish between the scan and the sleep is not missed.
+            for (size_t i = 0; i < sources.size(); i++) {
+                sources[i].signal->waiters.fetch_add(1, std::memory_order_seq_cst);
+                seen[i] = sources[i].signal->sequence.load(std::memory_order_seq_cst);
+            }
+            if (!collect(ready)) sleep(remaining_us);
+            for (auto &source : sources) source.signal->waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        cursor = (ready.front() + 1) % sources.size();
+        return ready.size();
+    }
+
+    // Convenience: the next ready source in round-robin order, or -1 on
+    // timeout.
+    int next(int64_t timeout_ms = -1) {
+        if (!wait(scratch, timeout_ms)) return -1;
+        return static_cast<int>(scratch.front());
+    }
+};
+
+} // namespace NanoBroker
+#endif
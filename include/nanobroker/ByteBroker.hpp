@@ -0,0 +1,480 @@
+#ifndef NANOBROKER_BYTE_BROKER_HPP
+#define NANOBROKER_BYTE_BROKER_HPP
+
+#include "NanoBroker.hpp"
+
+namespace NanoBroker {
+
+// Variable-length ring: records are packed back to back in a byte arena
+// instead of occupying a fixed sizeof(T) slot each. Head and tails are
+// monotonic byte positions; the arena offset is position % ArenaSize.
+
+enum class RecordKind : uint32_t {
+    DATA = 0,
+    PADDING = 1 // Fills the unused tail of the arena before a wrap
+};
+
+struct alignas(64) RecordHeader {
+    std::atomic<uint64_t> position{0}; // Ring position the record was written at
+    std::atomic<SlotState> state{SlotState::FREE};
+    RecordKind kind;
+    uint64_t size;   // Payload bytes
+    uint64_t stride; // Header + payload, rounded up to 64 bytes
+    int64_t commit_ns; // Non-zero on sampled commits (see LATENCY_SAMPLE_MASK)
+};
+
+static_assert(sizeof(RecordHeader) == 64, "RecordHeader must fill one cache line");
+
+struct ByteView {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    explicit operator bool() const { return data != nullptr; }
+};
+
+template <size_t ArenaSize, size_t MaxConsumers>
+struct alignas(64) SharedByteChannel {
+
+    SegmentHeader header;
+    NanoString<1024> schema;  // Free-form record layout chosen by the creator
+
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tails[MaxConsumers];
+    alignas(64) std::atomic<uint64_t> active_mask; // Bit i set = consumer i attached
+    alignas(64) std::atomic<int64_t> heartbeats[MaxConsumers];
+    alignas(64) std::atomic<int32_t> owner_pids[MaxConsumers];
+    alignas(64) std::atomic<int32_t> write_owner; // Pid holding the producer lock, 0 if free
+    alignas(64) ChannelSignal signal;
+    alignas(64) ChannelMetrics<MaxConsumers> metrics;
+
+    alignas(64) uint8_t arena[ArenaSize];
+};
+
+template <size_t ArenaSize = 8 * 1024 * 1024, size_t MaxConsumers = 16>
+class ByteBroker {
+    static_assert(ArenaSize % 64 == 0, "ArenaSize must be a multiple of 64 bytes");
+    static_assert(ArenaSize >= 2 * sizeof(RecordHeader), "ArenaSize too small");
+    static_assert(ArenaSize <= UINT32_MAX, "ArenaSize must fit the 32-bit capacity field");
+    static_assert(MaxConsumers <= 64, "MaxConsumers is limited by the 64-bit active mask");
+
+    using Channel = SharedByteChannel<ArenaSize, MaxConsumers>;
+
+private:
+    std::string name;
+    SharedSegment segment;
+    Channel *channel;
+    bool is_owner;
+    int consumer_id;
+    uint64_t local_epoch_cache = 0;
+    BrokerSettings settings;
+    RecordHeader *pending_record = nullptr;
+    uint64_t pending_end = 0;
+    uint64_t peek_position = 0;
+    uint64_t peek_stride = 0;
+    uint64_t cached_min_tail = 0; // Lower bound on every active tail
+    uint64_t sampled_position = UINT64_MAX; // Last record fed to the latency histogram
+    int64_t blocked_since = 0;    // When prepare_publish() first got refused
+    int64_t last_heartbeat = 0;   // Coarse tick of our last heartbeat store
+    int32_t self_pid = static_cast<int32_t>(getpid());
+
+    int64_t now_ms() const { return detail::coarse_now_ms(); }
+
+    static uint64_t stride_for(size_t bytes) {
+        return (sizeof(RecordHeader) + bytes + 63) & ~uint64_t(63);
+    }
+
+    RecordHeader *record_at(uint64_t position) const {
+        return reinterpret_cast<RecordHeader *>(&channel->arena[position % ArenaSize]);
+    }
+
+    // Takes the producer lock. A holder whose process has died is replaced:
+    // it never moved head, so its half-written record was never visible and
+    // is simply written over.
+    void lock_writer() {
+        int32_t holder = 0;
+        for (uint32_t spin = 1; !channel->write_owner.compare_exchange_weak(holder, self_pid, std::memory_order_acquire,
+                                                                            std::memory_order_relaxed); spin++) {
+            if ((spin & 1023) == 0 && detail::process_gone(holder) &&
+                channel->write_owner.compare_exchange_strong(holder, self_pid, std::memory_order_acquire)) {
+                channel->metrics.recovered.fetch_add(1, std::memory_order_relaxed);
+                std::cerr << "[NanoBroker] Took over write lock from dead process " << holder << std::endl;
+                return;
+            }
+            holder = 0;
+            _mm_pause();
+        }
+    }
+
+    void unlock_writer() { channel->write_owner.store(0, std::memory_order_release); }
+
+    // Throws once this process no longer holds consumer_id (kicked, and
+    // possibly claimed by another process since).
+    void require_consumer_id() const {
+        if (!detail::holds_consumer_id(channel->active_mask, channel->owner_pids, consumer_id, self_pid)) {
+            throw std::runtime_error("Consumer disconnected.");
+        }
+    }
+
+    // Makes room for a record ending at `end` (write lock held): kicks stale
+    // consumers, skips laggards forward under OVERWRITE_OLD and recomputes
+    // cached_min_tail. Returns false if a consumer blocks under BLOCK.
+    bool refresh_min_tail(uint64_t position, uint64_t end, int64_t timeout_ms) {
+        int64_t now = now_ms();
+        uint64_t min_tail = position;
+        uint64_t mask = channel->active_mask.load(std::memory_order_acquire);
+
+        while (mask) {
+            size_t i = __builtin_ctzll(mask);
+            mask &= mask - 1;
+
+            uint64_t t = channel->tails[i].load(std::memory_order_acquire);
+            bool kicked = false;
+            while (end - t > ArenaSize && t != position) {
+
+                int64_t last = channel->heartbeats[i].load(std::memory_order_relaxed);
+                if ((now - last) > timeout_ms) {
+                    channel->active_mask.fetch_and(~detail::consumer_bit(i), std::memory_order_release);
+                    channel->metrics.kicked.fetch_add(1, std::memory_order_relaxed);
+                    std::cerr << "[NanoBroker] Auto-kicked consumer " << i << std::endl;
+                    kicked = true;
+                    break;
+                }
+
+                if (settings.overflow_policy == OverflowPolicy::BLOCK) return false;
+
+                // Skip the consumer's oldest record. Records behind head are
+                // committed, so their stride is stable while we hold the lock.
+                uint64_t next = t + record_at(t)->stride;
+                if (channel->tails[i].compare_exchange_strong(t, next, std::memory_order_acq_rel)) {
+                    if (record_at(t)->kind == RecordKind::DATA) {
+                        channel->metrics.consumers[i].overwritten.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    t = next;
+                }
+            }
+            if (!kicked && t < min_tail) min_tail = t;
+        }
+
+        cached_min_tail = min_tail;
+        return true;
+    }
+
+public:
+    // A record may take at most half the arena so that it always fits
+    // contiguously after at most one padding record.
+    static constexpr size_t max_record_size() { return ArenaSize / 2 - sizeof(RecordHeader); }
+
+    // `schema` is stored in the segment header at creation so attaching
+    // processes can discover the record layout (see schema()).
+    ByteBroker(const std::string &channel_name, bool create = false, int id = 0,
+               BrokerSettings custom_settings = BrokerSettings(), const std::string &schema = "")
+        : name("/" + channel_name), channel(nullptr),
+          is_owner(create), consumer_id(create ? -1 : id), settings(custom_settings)
+    {
+        detail::apply_thread_settings(settings);
+        segment.open(name, sizeof(Channel), create, settings);
+        channel = static_cast<Channel *>(segment.data());
+
+        if (create) {
+            channel->header.magic = MAGIC_NUMBER;
+            channel->header.version = PROTOCOL_VERSION;
+            std::random_device rd;
+            std::mt19937_64 gen(rd());
+            std::uniform_int_distribution<uint64_t> dis;
+            channel->header.producer_epoch = dis(gen);
+            channel->header.struct_size = 0;
+            channel->header.buffer_capacity = ArenaSize;
+            detail::describe_layout(channel, ChannelKind::BYTES, MaxConsumers, 0, channel->arena);
+            if (schema.size() >= sizeof(channel->schema.buffer))
+                throw std::runtime_error("Schema too long for segment header");
+            channel->schema = schema;
+
+            new (&channel->head) std::atomic<uint64_t>(0);
+            new (&channel->signal) ChannelSignal();
+            new (&channel->active_mask) std::atomic<uint64_t>(0);
+            new (&channel->write_owner) std::atomic<int32_t>(0);
+            new (&channel->metrics) ChannelMetrics<MaxConsumers>();
+            for (size_t i = 0; i < MaxConsumers; i++) {
+                new (&channel->tails[i]) std::atomic<uint64_t>(0);
+                new (&channel->heartbeats[i]) std::atomic<int64_t>(0);
+                new (&channel->owner_pids[i]) std::atomic<int32_t>(0);
+            }
+        } else {
+
+            const SegmentHeader &header = channel->header;
+            if (header.magic != MAGIC_NUMBER) throw std::runtime_error("SHM Magic Mismatch! (Old/Corrupt Memory)");
+            if (header.version != PROTOCOL_VERSION) throw std::runtime_error("Protocol Version Mismatch!");
+            if (header.kind != ChannelKind::BYTES) throw std::runtime_error("Channel is not a variable-length channel!");
+            if (header.buffer_capacity != ArenaSize) throw std::runtime_error("Arena Size Mismatch!");
+            if (header.max_consumers != MaxConsumers) throw std::runtime_error("Max Consumers Mismatch!");
+
+            if (id != -99) {
+                consumer_id = detail::claim_consumer_id(channel->active_mask, channel->heartbeats,
+                                                        channel->owner_pids, MaxConsumers, id,
+                                                        settings.producer_timeout_ms);
+
+                uint64_t h = channel->head.load(std::memory_order_relaxed);
+                channel->tails[consumer_id].store(h, std::memory_order_release);
+                new (&channel->metrics.consumers[consumer_id]) ConsumerMetrics();
+            }
+        }
+    }
+
+    std::string schema() const { return channel->schema.c_str(); }
+
+    ~ByteBroker() {
+        if (!is_owner && channel && consumer_id != -99) {
+            detail::release_consumer_id(channel->active_mask, channel->owner_pids, consumer_id);
+        }
+    }
+
+    // The consumer ID in use (useful with AUTO_ID); -1 for the creator.
+    int id() const { return consumer_id; }
+
+    ByteBroker(const ByteBroker &) = delete;
+    ByteBroker &operator=(const ByteBroker &) = delete;
+
+    // Reserves exactly `bytes` of payload. Returns nullptr when a consumer
+    // blocks the reservation under OverflowPolicy::BLOCK.
+    uint8_t *prepare_publish(size_t bytes, int64_t timeout_ms = 2000) {
+        if (bytes > max_record_size()) throw std::runtime_error("Record larger than arena allows");
+
+        lock_writer();
+
+        uint64_t position = channel->head.load(std::memory_order_relaxed);
+        uint64_t stride = stride_for(bytes);
+        uint64_t offset = position % ArenaSize;
+        uint64_t padding = (offset + stride > ArenaSize) ? ArenaSize - offset : 0;
+        uint64_t end = position + padding + stride;
+
+        if (end > cached_min_tail + ArenaSize && !refresh_min_tail(position, end, timeout_ms)) {
+            unlock_writer();
+            channel->metrics.blocked.fetch_add(1, std::memory_order_relaxed);
+            if (blocked_since == 0) blocked_since = detail::now_ns();
+            return nullptr;
+        }
+
+        if (blocked_since != 0) {
+            channel->metrics.blocked_ns.fetch_add(detail::now_ns() - blocked_since, std::memory_order_relaxed);
+            blocked_since = 0;
+        }
+
+        if (padding) {
+            RecordHeader *pad = record_at(position);
+            pad->state.store(SlotState::WRITING, std::memory_order_relaxed);
+            pad->kind = RecordKind::PADDING;
+            pad->size = 0;
+            pad->stride = padding;
+            pad->commit_ns = 0;
+            pad->position.store(position, std::memory_order_relaxed);
+            pad->state.store(SlotState::READY, std::memory_order_release);
+            position += padding;
+        }
+
+        pending_record = record_at(position);
+        pending_record->state.store(SlotState::WRITING, std::memory_order_release);
+        pending_record->kind = RecordKind::DATA;
+        pending_record->size = bytes;
+        pending_record->stride = stride;
+        pending_record->position.store(position, std::memory_order_release);
+        pending_end = end;
+
+        return reinterpret_cast<uint8_t *>(pending_record + 1);
+    }
+
+    void commit_publish() {
+        if (!pending_record) return;
+
+        // Producers are serialised by write_owner, so published has one writer.
+        uint64_t count = channel->metrics.published.load(std::memory_order_relaxed);
+        pending_record->commit_ns = (count & LATENCY_SAMPLE_MASK) == 0 ? detail::now_ns() : 0;
+        pending_record->state.store(SlotState::READY, std::memory_order_release);
+        channel->head.store(pending_end, std::memory_order_release);
+        detail::count_local(channel->metrics.published);
+
+        unlock_writer();
+        pending_record = nullptr;
+
+        detail::notify_publish(channel->signal);
+    }
+
+    // Drops the reservation. Head never moved, so nothing becomes visible.
+    void abort_publish() {
+        if (!pending_record) return;
+
+        pending_record->state.store(SlotState::FREE, std::memory_order_relaxed);
+        detail::count_local(channel->metrics.aborted);
+        unlock_writer();
+        pending_record = nullptr;
+    }
+
+    // Commits fewer bytes than were reserved (e.g. after encoding into an
+    // upper-bound reservation). The unused tail is handed back to the ring.
+    void commit_publish(size_t bytes_used) {
+        if (!pending_record) return;
+        if (bytes_used < pending_record->size) {
+            uint64_t stride = stride_for(bytes_used);
+            pending_end -= pending_record->stride - stride;
+            pending_record->size = bytes_used;
+            pending_record->stride = stride;
+        }
+        commit_publish();
+    }
+
+    ByteView peek() {
+
+        uint64_t current_epoch = channel->header.producer_epoch;
+
+        if (local_epoch_cache == 0) local_epoch_cache = current_epoch;
+
+        if (current_epoch != local_epoch_cache) {
+            std::cerr << "[NanoBroker] Producer restarted! Resetting tail." << std::endl;
+
+            uint64_t new_head = channel->head.load(std::memory_order_relaxed);
+            channel->tails[consumer_id].store(new_head, std::memory_order_release);
+            detail::count_local(channel->metrics.consumers[consumer_id].epoch_resets);
+            local_epoch_cache = current_epoch;
+            return {};
+        }
+
+        require_consumer_id();
+        detail::touch_heartbeat(channel->heartbeats[consumer_id], last_heartbeat);
+
+        // Bounded: each pass either returns, or consumes a padding record or
+        // a tail move made by an overwriting producer.
+        for (int attempt = 0; attempt < 4; attempt++) {
+            uint64_t t = channel->tails[consumer_id].load(std::memory_order_acquire);
+            if (t == channel->head.load(std::memory_order_acquire)) {
+                return {};
+            }
+
+            RecordHeader *record = record_at(t);
+            if (record->position.load(std::memory_order_acquire) != t) {
+                detail::count_local(channel->metrics.consumers[consumer_id].lap_retries);
+                continue;
+            }
+
+            int spin = 0;
+            while (record->state.load(std::memory_order_acquire) != SlotState::READY) {
+                _mm_pause();
+                if (++spin > 10000) {
+                    detail::count_local(channel->metrics.consumers[consumer_id].ready_timeouts);
+                    return {};
+                }
+            }
+
+            // Copy the header fields out, then check that we still hold our
+            // ID and that an overwriting producer has not moved our tail
+            // past this record meanwhile: it always does so before reusing
+            // the bytes, so if the tail is still t the size and stride read
+            // are sound.
+            RecordKind kind = record->kind;
+            uint64_t size = record->size;
+            uint64_t stride = record->stride;
+            int64_t commit_ns = record->commit_ns;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            require_consumer_id();
+            if (channel->tails[consumer_id].load(std::memory_order_relaxed) != t ||
+                record->position.load(std::memory_order_relaxed) != t) {
+                detail::count_local(channel->metrics.consumers[consumer_id].lap_retries);
+                continue;
+            }
+            if (size > stride - sizeof(RecordHeader)) size = stride - sizeof(RecordHeader);
+
+            if (kind == RecordKind::PADDING) {
+                channel->tails[consumer_id].compare_exchange_strong(t, t + stride, std::memory_order_acq_rel);
+                continue;
+            }
+
+            if (commit_ns != 0 && sampled_position != t) {
+                detail::record_latency(channel->metrics.latency, commit_ns);
+                sampled_position = t;
+            }
+
+            peek_position = t;
+            peek_stride = stride;
+            return {reinterpret_cast<const uint8_t *>(record + 1), static_cast<size_t>(size)};
+        }
+        return {};
+    }
+
+    // True if the record returned by the last peek() has not been reclaimed
+    // by a producer since. Call it after copying out of the record: a true
+    // result means the copy is consistent (seqlock read check). Under BLOCK
+    // it is always true; a kicked consumer throws instead.
+    bool peek_valid() {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        require_consumer_id();
+        if (channel->tails[consumer_id].load(std::memory_order_relaxed) == peek_position) return true;
+
+        detail::count_local(channel->metrics.consumers[consumer_id].torn_reads);
+        return false;
+    }
+
+    void release() {
+        require_consumer_id();
+        detail::touch_heartbeat(channel->heartbeats[consumer_id], last_heartbeat);
+        if (peek_stride == 0) return;
+
+        // Fails harmlessly if an overwriting producer already moved us on;
+        // it counted the record as overwritten then.
+        uint64_t expected = peek_position;
+        if (channel->tails[consumer_id].compare_exchange_strong(expected, peek_position + peek_stride,
+                                                                std::memory_order_acq_rel)) {
+            detail::count_local(channel->metrics.consumers[consumer_id].consumed);
+        }
+        peek_stride = 0;
+    }
+
+    ByteView wait_and_peek(int64_t timeout_ms = -1) {
+        return detail::wait_for_data(settings, channel->signal, timeout_ms, [this] { return peek(); });
+    }
+
+    // Readiness probe; touches neither heartbeat nor tail.
+    bool has_data() const {
+        if (consumer_id < 0) return false;
+        return channel->tails[consumer_id].load(std::memory_order_acquire) !=
+               channel->head.load(std::memory_order_acquire);
+    }
+
+    ChannelSignal &signal() { return channel->signal; }
+
+    void print_stats() {
+        uint64_t h = channel->head.load(std::memory_order_relaxed);
+        int64_t now = now_ms();
+        std::cout << "--- NanoBroker Stats [" << name << "] ---" << std::endl;
+        std::cout << "Magic: " << std::hex << channel->header.magic << std::dec << std::endl;
+        std::cout << "Head: " << h << " bytes (arena " << ArenaSize << ")" << std::endl;
+
+        for (size_t i = 0; i < MaxConsumers; i++) {
+            if (detail::is_active(channel->active_mask, i)) {
+                uint64_t t = channel->tails[i].load(std::memory_order_relaxed);
+                int64_t hb = channel->heartbeats[i].load(std::memory_order_relaxed);
+                std::cout << "  [ID " << i << "] Tail: " << t << " | Lag: " << (h - t)
+                          << " bytes | Age: " << (now - hb) << "ms" << std::endl;
+            }
+        }
+        std::cout << "-----------------------------------" << std::endl;
+    }
+
+    const ChannelMetrics<MaxConsumers> &metrics() const { return channel->metrics; }
+
+    void print_metrics() {
+        uint64_t h = channel->head.load(std::memory_order_relaxed);
+        std::cout << "--- NanoBroker Metrics [" << name << "] ---" << std::endl;
+        std::cout << "Head: " << h << " bytes (arena " << ArenaSize << ")" << std::endl;
+        detail::print_metrics(channel->metrics, channel->active_mask, h, channel->tails);
+        std::cout << "-----------------------------------" << std::endl;
+    }
+
+    void force_disconnect_consumer(int id) {
+        if (id < 0 || id >= (int)MaxConsumers) return;
+        channel->active_mask.fetch_and(~detail::consumer_bit(id), std::memory_order_release);
+    }
+
+    static void unlink_memory(const std::string &name) {
+        SharedSegment::unlink("/" + name);
+    }
+};
+
+} // namespace NanoBroker
+#endif
@@ -0,0 +1,309 @@
+#ifndef NANOBROKER_CAPTURE_HPP
+#define NANOBROKER_CAPTURE_HPP
+
+#include "NanoBroker.hpp"
+#include <deque>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <vector>
+
+namespace NanoBroker {
+
+// One buffer handed back by a capture device.
+struct CapturedBuffer {
+    unsigned index = 0;       // As passed to queue()
+    size_t bytes = 0;         // Payload bytes the device wrote
+    int64_t timestamp_ns = 0; // CLOCK_MONOTONIC capture time
+    bool error = false;       // Device flagged the buffer as corrupt
+};
+
+// V4L2 capture in user-pointer mode: the driver writes each frame straight
+// into memory we queue, which CaptureAdapter points at broker slots.
+// Drivers built on videobuf2-vmalloc/sg (uvcvideo, vivid) accept arbitrary
+// user memory; contiguous-DMA drivers may reject it in request_buffers().
+class V4L2Device {
+    std::string path;
+    int fd = -1;
+    v4l2_format format{};
+    bool streaming = false;
+
+    static int xioctl(int fd, unsigned long request, void *arg) {
+        int r;
+        do { r = ioctl(fd, request, arg); } while (r == -1 && errno == EINTR);
+        return r;
+    }
+
+    void fail(const std::string &what) const {
+        throw std::runtime_error(what + " failed on " + path + ": " + std::strerror(errno));
+    }
+
+public:
+    V4L2Device(const std::string &device, uint32_t width, uint32_t height, uint32_t fourcc = V4L2_PIX_FMT_YUYV)
+        : path(device)
+    {
+        fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK);
+        if (fd == -1) fail("open");
+
+        v4l2_capability caps{};
+        if (xioctl(fd, VIDIOC_QUERYCAP, &caps) == -1) { ::close(fd); fail("VIDIOC_QUERYCAP"); }
+        if (!(caps.device_caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps.device_caps & V4L2_CAP_STREAMING)) {
+            ::close(fd);
+            throw std::runtime_error(path + " is not a streaming capture device");
+        }
+
+        format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        format.fmt.pix.width = width;
+        format.fmt.pix.height = height;
+        format.fmt.pix.pixelformat = fourcc;
+        format.fmt.pix.field = V4L2_FIELD_NONE;
+        if (xioctl(fd, VIDIOC_S_FMT, &format) == -1) { ::close(fd); fail("VIDIOC_S_FMT"); }
+        if (format.fmt.pix.pixelformat != fourcc) {
+            std::cerr << "[NanoBroker] " << path << " substituted pixel format" << std::endl;
+        }
+    }
+
+    ~V4L2Device() {
+        stop();
+        v4l2_requestbuffers req{};
+        req.count = 0;
+        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_USERPTR;
+        xioctl(fd, VIDIOC_REQBUFS, &req);
+        ::close(fd);
+    }
+
+    V4L2Device(const V4L2Device &) = delete;
+    V4L2Device &operator=(const V4L2Device &) = delete;
+
+    // Negotiated format (the driver may adjust the requested size).
+    uint32_t width() const { return format.fmt.pix.width; }
+    uint32_t height() const { return format.fmt.pix.height; }
+    uint32_t fourcc() const { return format.fmt.pix.pixelformat; }
+    uint32_t bytes_per_line() const { return format.fmt.pix.bytesperline; }
+    size_t frame_size() const { return format.fmt.pix.sizeimage; }
+
+    void request_buffers(unsigned count) {
+        v4l2_requestbuffers req{};
+        req.count = count;
+        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_USERPTR;
+        if (xioctl(fd, VIDIOC_REQBUFS, &req) == -1) fail("VIDIOC_REQBUFS (USERPTR)");
+        if (req.count < count) throw std::runtime_error(path + " granted fewer capture buffers than requested");
+    }
+
+    void queue(unsigned index, void *memory, size_t length) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_USERPTR;
+        buf.index = index;
+        buf.m.userptr = reinterpret_cast<unsigned long>(memory);
+        buf.length = length;
+        if (xioctl(fd, VIDIOC_QBUF, &buf) == -1) fail("VIDIOC_QBUF");
+    }
+
+    // Waits up to timeout_ms for a filled buffer. Returns false on timeout.
+    bool dequeue(CapturedBuffer &out, int timeout_ms) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0) return false;
+
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_USERPTR;
+        if (xioctl(fd, VIDIOC_DQBUF, &buf) == -1) {
+            if (errno == EAGAIN) return false;
+            fail("VIDIOC_DQBUF");
+        }
+        out.index = buf.index;
+        out.bytes = buf.bytesused;
+        out.timestamp_ns = buf.timestamp.tv_sec * 1000000000LL + buf.timestamp.tv_usec * 1000LL;
+        out.error = (buf.flags & V4L2_BUF_FLAG_ERROR) != 0;
+        return true;
+    }
+
+    void start() {
+        if (streaming) return;
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(fd, VIDIOC_STREAMON, &type) == -1) fail("VIDIOC_STREAMON");
+        streaming = true;
+    }
+
+    // Also returns every queued buffer to us.
+    void stop() {
+        if (!streaming) return;
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(fd, VIDIOC_STREAMOFF, &type);
+        streaming = false;
+    }
+};
+
+// Stand-in for V4L2Device that "captures" back-to-back raw frames from a
+// file at a fixed rate, looping at the end. Each frame is read() straight
+// into the queued buffer, so pipelines and the zero-copy ingest path can be
+// exercised without a camera.
+class RawFileSource {
+    std::string path;
+    int fd = -1;
+    uint32_t frame_width, frame_height, frame_fourcc, bytes_per_pixel;
+    off_t file_size = 0;
+    off_t offset = 0;
+    int64_t period_ns;
+    int64_t next_due = 0;
+
+    struct Queued { unsigned index; void *memory; };
+    std::deque<Queued> queued;
+
+public:
+    RawFileSource(const std::string &file, uint32_t width, uint32_t height, uint32_t bytes_pp = 2,
+                  uint32_t fourcc = V4L2_PIX_FMT_YUYV, double fps = 30)
+        : path(file), frame_width(width), frame_height(height), frame_fourcc(fourcc), bytes_per_pixel(bytes_pp),
+          period_ns(fps > 0 ? static_cast<int64_t>(1e9 / fps) : 0)
+    {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) throw std::runtime_error("Cannot open raw video " + path);
+        struct stat st;
+        fstat(fd, &st);
+        file_size = st.st_size;
+        if (file_size < static_cast<off_t>(frame_size())) {
+            ::close(fd);
+            throw std::runtime_error(path + " holds less than one frame");
+        }
+    }
+
+    ~RawFileSource() { ::close(fd); }
+
+    RawFileSource(const RawFileSource &) = delete;
+    RawFileSource &operator=(const RawFileSource &) = delete;
+
+    uint32_t width() const { return frame_width; }
+    uint32_t height() const { return frame_height; }
+    uint32_t fourcc() const { return frame_fourcc; }
+    uint32_t bytes_per_line() const { return frame_width * bytes_per_pixel; }
+    size_t frame_size() const { return size_t(bytes_per_line()) * frame_height; }
+
+    void request_buffers(unsigned) {}
+    void queue(unsigned index, void *memory, size_t) { queued.push_back({index, memory}); }
+    void start() { next_due = detail::now_ns(); }
+    void stop() { queued.clear(); }
+
+    bool dequeue(CapturedBuffer &out, int timeout_ms) {
+        if (queued.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+            return false;
+        }
+
+        int64_t wait_ns = next_due - detail::now_ns();
+        if (wait_ns > timeout_ms * 1000000LL) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+            return false;
+        }
+        if (wait_ns > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(wait_ns));
+        next_due += period_ns;
+
+        Queued buffer = queued.front();
+        queued.pop_front();
+        if (offset + static_cast<off_t>(frame_size()) > file_size) offset = 0;
+        ssize_t n = pread(fd, buffer.memory, frame_size(), offset);
+        offset += frame_size();
+
+        out.index = buffer.index;
+        out.bytes = n > 0 ? n : 0;
+        out.timestamp_ns = detail::now_ns();
+        out.error = n != static_cast<ssize_t>(frame_size());
+        return true;
+    }
+};
+
+// Zero-copy ingest: keeps `depth` broker slots claimed as tickets and queued
+// to the device as capture buffers, so the device writes each frame straight
+// into a slot's pixels. A dequeued buffer fills in the frame header and
+// commits its ticket; a fresh ticket is queued in its place. Frame must have
+// CameraFrame's fields (see video_protocol.hpp).
+template <typename Frame, size_t BufferSize, size_t MaxConsumers, typename Device>
+class CaptureAdapter {
+    using Channel = Broker<Frame, BufferSize, MaxConsumers>;
+
+    Channel &broker;
+    Device &device;
+    std::vector<typename Channel::Ticket> tickets; // By buffer index; empty if not queued
+    int producer_id;
+    int frame_count = 0;
+    int64_t claim_timeout_ms;
+
+    // Claims a slot for buffer `index` and hands it to the device. Fails
+    // (and is retried by poll()) while the ring is full under BLOCK.
+    bool requeue(unsigned index) {
+        typename Channel::Ticket ticket = broker.claim(claim_timeout_ms);
+        if (!ticket) return false;
+        try {
+            device.queue(index, ticket.data->pixels, sizeof(ticket.data->pixels));
+        } catch (...) {
+            broker.abort(ticket);
+            throw;
+        }
+        tickets[index] = ticket;
+        return true;
+    }
+
+public:
+    CaptureAdapter(Channel &producer, Device &source, unsigned depth = 4, int id = 0,
+                   int64_t timeout_ms = 2000)
+        : broker(producer), device(source), tickets(depth), producer_id(id), claim_timeout_ms(timeout_ms)
+    {
+        if (depth == 0 || depth >= BufferSize) throw std::runtime_error("Capture depth must be 1..BufferSize-1");
+        if (device.frame_size() > sizeof(Frame::pixels)) throw std::runtime_error("Capture frame exceeds slot pixels");
+
+        device.request_buffers(depth);
+        for (unsigned i = 0; i < depth; i++) requeue(i);
+        device.start();
+    }
+
+    ~CaptureAdapter() {
+        device.stop();
+        for (auto &ticket : tickets) broker.abort(ticket);
+    }
+
+    CaptureAdapter(const CaptureAdapter &) = delete;
+    CaptureAdapter &operator=(const CaptureAdapter &) = delete;
+
+    // Waits up to timeout_ms for the next captured frame and publishes it.
+    // Returns true if a frame was committed.
+    bool poll(int timeout_ms = 100) {
+        for (unsigned i = 0; i < tickets.size(); i++) {
+            if (!tickets[i]) requeue(i);
+        }
+
+        CapturedBuffer captured;
+        if (!device.dequeue(captured, timeout_ms)) return false;
+
+        typename Channel::Ticket ticket = tickets[captured.index];
+        tickets[captured.index] = {};
+
+        bool ok = !captured.error && captured.bytes > 0;
+        if (ok) {
+            Frame *frame = ticket.data;
+            frame->producer_id = producer_id;
+            frame->frame_id = frame_count++;
+            frame->timestamp_ns = captured.timestamp_ns;
+            frame->width = device.width();
+            frame->height = device.height();
+            frame->channels = device.bytes_per_line() / device.width();
+            frame->data_size = captured.bytes;
+            uint32_t cc = device.fourcc();
+            char fourcc[5] = {char(cc), char(cc >> 8), char(cc >> 16), char(cc >> 24), '\0'};
+            frame->format = fourcc;
+            broker.commit(ticket);
+        } else {
+            broker.abort(ticket);
+        }
+
+        requeue(captured.index);
+        return ok;
+    }
+
+    // Frames committed so far.
+    int frames() const { return frame_count; }
+};
+
+} // namespace NanoBroker
+#endif
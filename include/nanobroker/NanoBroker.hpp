@@ -1,14 +1,28 @@
 #ifndef NANOBROKER_HPP
 #define NANOBROKER_HPP
 
+#include <algorithm>
 #include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
 #include <cstring>
+#include <ctime>
 #include <fcntl.h>
+#include <fstream>
 #include <immintrin.h>
 #include <iostream>
+#include <linux/futex.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
 #include <stdexcept>
 #include <string>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/syscall.h>
 #include <thread>
 #include <type_traits>
 #include <unistd.h>
@@ -18,16 +32,31 @@ namespace NanoBroker {
 
 
 const uint64_t MAGIC_NUMBER = 0x4E414E4F42524F4B; // "NANOBROK" in hex
-const uint32_t PROTOCOL_VERSION = 2;
+const uint32_t PROTOCOL_VERSION = 13;
 const int MAX_CONSUMERS = 16;
+const int AUTO_ID = -1; // Consumer ID argument: claim the lowest free ID
 
 enum class OverflowPolicy { BLOCK, OVERWRITE_OLD };
 
+enum class ChannelKind : uint32_t {
+    FIXED = 1, // Broker: BufferSize slots of sizeof(T)
+    BYTES = 2, // ByteBroker: variable-length records in a byte arena
+    SPSC = 3   // SpscBroker: BufferSize plain slots of sizeof(T), one consumer
+};
+
+// How a consumer waits in wait_and_peek():
+//   SPIN   - _mm_pause only, lowest latency, burns a core
+//   HYBRID - spin, then yield, then 1us sleeps
+//   FUTEX  - spin briefly, then block in the kernel until the next commit
+enum class WaitStrategy { SPIN, HYBRID, FUTEX };
+
 
 enum class SlotState : uint32_t {
     FREE = 0,
     WRITING = 1,
-    READY = 2
+    READY = 2,
+    ABORTED = 3, // Claimed then abandoned; consumers step over it
+    QUEUED = 4   // Claimed by a ticket (e.g. a capture buffer) that may stay open for a frame period
 };
 
 struct BrokerSettings {
@@ -35,39 +64,660 @@ struct BrokerSettings {
     int64_t producer_timeout_ms = 10000;
     int spin_iterations = 1000;
     int yield_iterations = 10000;
+    WaitStrategy wait_strategy = WaitStrategy::HYBRID;
+    bool conflate = false;     // wait_and_peek() returns the newest frame (see peek_latest())
+
+    // Segment placement (see SharedSegment). Creator-side options decide
+    // where the segment lives; prefault/lock_memory apply to every process.
+    bool huge_pages = false;   // hugetlbfs if mounted, else MADV_HUGEPAGE on /dev/shm
+    bool prefault = false;     // Fault every page in at attach, not in the hot loop
+    bool lock_memory = false;  // mlock() the mapping (needs RLIMIT_MEMLOCK)
+    int numa_node = -1;        // Bind segment pages to this node (-1 = default policy)
+
+    // Applied once by each broker constructor to the thread running it,
+    // before its pages are touched (so prefaulted pages land on that CPU's
+    // node). Leave them unset for classes that construct brokers on your
+    // behalf (Relay, TransformStage, ...). Busy-polling consumers belong on
+    // isolated cores away from the producer's core.
+    int cpu_affinity = -1;     // Pin to this CPU (-1 = leave as is)
+    int realtime_priority = 0; // SCHED_FIFO priority 1-99 (0 = leave as is; needs CAP_SYS_NICE)
 };
 
+// Publish notification word shared by producers and blocking consumers.
+// Producers bump `sequence` on every commit and only enter the kernel
+// when `waiters` says someone is asleep on it.
+struct alignas(64) ChannelSignal {
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> waiters{0};
+};
+
+const size_t LATENCY_BUCKETS = 32;          // Bucket b counts latencies in [2^(b-1), 2^b) ns
+const uint64_t LATENCY_SAMPLE_MASK = 63;    // Producers timestamp one commit in 64
+
+// Counters owned by one consumer ID, one cache line each so consumers never
+// share a line. `overwritten` is also bumped by producers pushing the tail.
+struct alignas(64) ConsumerMetrics {
+    std::atomic<uint64_t> consumed{0};
+    std::atomic<uint64_t> overwritten{0};    // Frames skipped under OVERWRITE_OLD
+    std::atomic<uint64_t> lap_retries{0};    // peek() found a newer sequence than its tail
+    std::atomic<uint64_t> ready_timeouts{0}; // peek() gave up on an uncommitted slot
+    std::atomic<uint64_t> epoch_resets{0};   // Tail reset after a producer restart
+    std::atomic<uint64_t> conflated{0};      // Stale frames jumped by peek_latest()
+    std::atomic<uint64_t> torn_reads{0};     // peek_valid() found the frame overwritten
+};
+
+// Observability counters kept in the segment so tools like nanoadmin can
+// read them live. All updates are relaxed: values are statistics, not
+// synchronisation.
+template <size_t MaxConsumers>
+struct alignas(64) ChannelMetrics {
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> aborted{0};
+    std::atomic<uint64_t> blocked{0};    // prepare_publish() refusals under BLOCK
+    std::atomic<uint64_t> blocked_ns{0}; // Time from first refusal to the next claim
+    std::atomic<uint64_t> kicked{0};     // Consumers auto-kicked for a stale heartbeat
+    std::atomic<uint64_t> recovered{0};  // Slots or write locks reclaimed from dead producers
+
+    alignas(64) std::atomic<uint64_t> latency[LATENCY_BUCKETS]{}; // Commit to first peek
+    ConsumerMetrics consumers[MaxConsumers];
+};
+
+namespace detail {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32-bit");
+
+inline void futex_wait(std::atomic<uint32_t> *word, uint32_t expected, int64_t timeout_us) {
+    struct timespec ts;
+    struct timespec *tsp = nullptr;
+    if (timeout_us >= 0) {
+        ts.tv_sec = timeout_us / 1000000;
+        ts.tv_nsec = (timeout_us % 1000000) * 1000;
+        tsp = &ts;
+    }
+    // Not FUTEX_PRIVATE: the word lives in memory shared between processes.
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, tsp, nullptr, 0);
+}
+
+inline void futex_wake_all(std::atomic<uint32_t> *word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// CLOCK_MONOTONIC at kernel tick resolution (1-4 ms). The kernel keeps this
+// word current, so reading it is a vDSO load with no syscall and no TSC
+// read. Heartbeats and the auto-kick timeout need nothing finer.
+inline int64_t coarse_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Stores a consumer heartbeat only when the coarse tick has moved since the
+// last store, so a busy read loop dirties the shared line at most once per
+// tick instead of on every call.
+inline void touch_heartbeat(std::atomic<int64_t> &heartbeat, int64_t &last_stored) {
+    int64_t now = coarse_now_ms();
+    if (now != last_stored) {
+        heartbeat.store(now, std::memory_order_relaxed);
+        last_stored = now;
+    }
+}
+
+// Increment for counters with a single writer; avoids a locked RMW.
+inline void count_local(std::atomic<uint64_t> &counter, uint64_t n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void record_latency(std::atomic<uint64_t> *buckets, int64_t stamp_ns) {
+    int64_t elapsed = now_ns() - stamp_ns;
+    size_t bucket = elapsed > 0 ? 64 - __builtin_clzll(static_cast<uint64_t>(elapsed)) : 0;
+    if (bucket >= LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1;
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+// Below this, plain memcpy wins: the destination is likely read again soon
+// and fits in cache anyway.
+const size_t STREAM_COPY_THRESHOLD = 256 * 1024;
+
+// memcpy for large frames using non-temporal (cache-bypassing) stores, so
+// copying a multi-MB frame does not evict the reader's or writer's working
+// set. Loads stay ordinary: non-temporal loads only differ from normal ones
+// on write-combining memory, which shm is not.
+inline void stream_copy(void *dst, const void *src, size_t bytes) {
+    if (bytes < STREAM_COPY_THRESHOLD) { std::memcpy(dst, src, bytes); return; }
+
+    uint8_t *d = static_cast<uint8_t *>(dst);
+    const uint8_t *s = static_cast<const uint8_t *>(src);
+
+    // Streaming stores need an aligned destination.
+    size_t head = (64 - (reinterpret_cast<uintptr_t>(d) & 63)) & 63;
+    std::memcpy(d, s, head);
+    d += head; s += head; bytes -= head;
+
+#if defined(__AVX512F__)
+    for (; bytes >= 64; bytes -= 64, d += 64, s += 64) {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(d), _mm512_loadu_si512(s));
+    }
+#elif defined(__AVX2__)
+    for (; bytes >= 64; bytes -= 64, d += 64, s += 64) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + 32));
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(d), a);
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(d + 32), b);
+    }
+#else
+    for (; bytes >= 64; bytes -= 64, d += 64, s += 64) {
+        for (int i = 0; i < 64; i += 16) {
+            _mm_stream_si128(reinterpret_cast<__m128i *>(d + i),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i)));
+        }
+    }
+#endif
+    // Streaming stores are weakly ordered; fence before anyone publishes.
+    _mm_sfence();
+    std::memcpy(d, s, bytes);
+}
+
+inline uint64_t consumer_bit(size_t id) { return uint64_t(1) << id; }
+
+inline bool is_active(const std::atomic<uint64_t> &mask, size_t id) {
+    return (mask.load(std::memory_order_relaxed) & consumer_bit(id)) != 0;
+}
+
+// True while `id` is active and still held by process `self`. A consumer
+// that was kicked and whose ID another process has claimed since sees the
+// bit set again, but not its pid.
+inline bool holds_consumer_id(const std::atomic<uint64_t> &mask, const std::atomic<int32_t> *owner_pids,
+                              size_t id, int32_t self) {
+    return is_active(mask, id) && owner_pids[id].load(std::memory_order_relaxed) == self;
+}
+
+// True once no process `pid` exists. Zombies count as alive until reaped,
+// and pids from another PID namespace cannot be checked.
+inline bool process_gone(int32_t pid) {
+    return pid > 0 && kill(pid, 0) == -1 && errno == ESRCH;
+}
+
+// Registers a consumer in the active mask with a CAS, so two processes can
+// never end up sharing an ID. AUTO_ID takes the lowest free ID. An explicit
+// ID that is already set is only taken over when its holder is gone: its
+// process no longer exists (so a crashed consumer can restart with its old
+// ID), or no holder was recorded and the heartbeat is older than stale_ms.
+// Returns the claimed ID; the caller then initialises the tail.
+inline int claim_consumer_id(std::atomic<uint64_t> &mask, std::atomic<int64_t> *heartbeats,
+                             std::atomic<int32_t> *owner_pids, size_t max_consumers, int requested,
+                             int64_t stale_ms) {
+    const int32_t self = static_cast<int32_t>(getpid());
+    const uint64_t all = max_consumers == 64 ? ~uint64_t(0) : (uint64_t(1) << max_consumers) - 1;
+
+    if (requested != AUTO_ID && (requested < 0 || requested >= static_cast<int>(max_consumers))) {
+        throw std::runtime_error("Invalid Consumer ID");
+    }
+
+    uint64_t m = mask.load(std::memory_order_acquire);
+    while (true) {
+        int id = requested;
+        if (id == AUTO_ID) {
+            uint64_t free_ids = ~m & all;
+            if (!free_ids) throw std::runtime_error("No free consumer ID (all MaxConsumers in use)");
+            id = __builtin_ctzll(free_ids);
+        }
+
+        if (!(m & consumer_bit(id))) {
+            // Our pid goes in before the bit, so a kicked previous holder
+            // releasing in between sees the ID is no longer its own
+            // (release_consumer_id) instead of clearing our new bit.
+            int32_t previous = owner_pids[id].load(std::memory_order_acquire);
+            if (!owner_pids[id].compare_exchange_strong(previous, self, std::memory_order_acq_rel)) {
+                m = mask.load(std::memory_order_acquire);
+                continue;
+            }
+            // Fresh heartbeat next, so the producer cannot see the new bit
+            // next to a previous holder's old heartbeat and kick us.
+            heartbeats[id].store(coarse_now_ms(), std::memory_order_relaxed);
+            if (mask.compare_exchange_strong(m, m | consumer_bit(id), std::memory_order_acq_rel)) return id;
+
+            // The mask moved (possibly a racing claimer won this ID): hand
+            // back the pid we displaced and retry with the reloaded mask.
+            int32_t mine = self;
+            owner_pids[id].compare_exchange_strong(mine, previous, std::memory_order_acq_rel);
+            continue;
+        }
+
+        int32_t holder = owner_pids[id].load(std::memory_order_acquire);
+        bool dead = process_gone(holder);
+        bool silent = holder <= 0 && coarse_now_ms() - heartbeats[id].load(std::memory_order_relaxed) > stale_ms;
+        if (!dead && !silent) throw std::runtime_error("Consumer ID already in use");
+
+        // Several processes may race for the same dead ID; the pid CAS picks one.
+        heartbeats[id].store(coarse_now_ms(), std::memory_order_relaxed);
+        if (owner_pids[id].compare_exchange_strong(holder, self, std::memory_order_acq_rel)) {
+            std::cerr << "[NanoBroker] Took over consumer ID " << id << " from a dead holder" << std::endl;
+            return id;
+        }
+        m = mask.load(std::memory_order_acquire);
+    }
+}
+
+// Drops our active bit unless the ID has been taken over since.
+inline void release_consumer_id(std::atomic<uint64_t> &mask, std::atomic<int32_t> *owner_pids, int id) {
+    if (owner_pids[id].load(std::memory_order_acquire) == static_cast<int32_t>(getpid())) {
+        mask.fetch_and(~consumer_bit(id), std::memory_order_release);
+    }
+}
+
+inline void notify_publish(ChannelSignal &signal) {
+    signal.sequence.fetch_add(1, std::memory_order_seq_cst);
+    if (signal.waiters.load(std::memory_order_seq_cst) != 0) {
+        futex_wake_all(&signal.sequence);
+    }
+}
+
+// Sleeps until the publish counter moves away from `seen` (read by the
+// caller before it last checked for data) or the timeout expires.
+inline void wait_for_publish(ChannelSignal &signal, uint32_t seen, int64_t timeout_us) {
+    signal.waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (signal.sequence.load(std::memory_order_seq_cst) == seen) {
+        futex_wait(&signal.sequence, seen, timeout_us);
+    }
+    signal.waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Shared wait loop for all broker flavours. `peek` returns something
+// testable as bool; a negative timeout waits forever.
+template <typename PeekFn>
+auto wait_for_data(const BrokerSettings &settings, ChannelSignal &signal, int64_t timeout_ms,
+                   PeekFn &&peek) -> decltype(peek()) {
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms);
+    int spin_count = 0;
+
+    decltype(peek()) result = peek();
+    while (!result) {
+        if (spin_count < settings.spin_iterations) {
+            _mm_pause(); spin_count++;
+        } else if (timeout_ms >= 0 && Clock::now() >= deadline) {
+            return result;
+        } else if (settings.wait_strategy == WaitStrategy::SPIN) {
+            _mm_pause();
+        } else if (settings.wait_strategy == WaitStrategy::HYBRID) {
+            if (spin_count < settings.yield_iterations) { std::this_thread::yield(); spin_count++; }
+            else { std::this_thread::sleep_for(std::chrono::microseconds(1)); }
+        } else {
+            int64_t remaining_us = -1;
+            if (timeout_ms >= 0) {
+                remaining_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    deadline - Clock::now()).count();
+                if (remaining_us < 0) remaining_us = 0;
+            }
+
+            signal.waiters.fetch_add(1, std::memory_order_seq_cst);
+            uint32_t seen = signal.sequence.load(std::memory_order_seq_cst);
+            result = peek();
+            if (!result) futex_wait(&signal.sequence, seen, remaining_us);
+            signal.waiters.fetch_sub(1, std::memory_order_relaxed);
+            if (result) break;
+        }
+        result = peek();
+    }
+    return result;
+}
+
+// Pins the calling thread to one CPU. Failures (offline CPU, cpuset) are
+// reported and ignored, like the other placement options.
+inline bool pin_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        std::cerr << "[NanoBroker] Pinning to CPU " << cpu << " failed: " << std::strerror(err) << std::endl;
+    }
+    return err == 0;
+}
+
+inline bool set_realtime_priority(int priority) {
+    struct sched_param param;
+    param.sched_priority = priority;
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0) {
+        std::cerr << "[NanoBroker] SCHED_FIFO priority " << priority << " failed: " << std::strerror(err) << std::endl;
+    }
+    return err == 0;
+}
+
+inline void apply_thread_settings(const BrokerSettings &settings) {
+    if (settings.cpu_affinity >= 0) pin_thread(settings.cpu_affinity);
+    if (settings.realtime_priority > 0) set_realtime_priority(settings.realtime_priority);
+}
+
+inline std::string hugetlbfs_mount() {
+    std::ifstream mounts("/proc/mounts");
+    std::string device, path, type, rest;
+    while (mounts >> device >> path >> type && std::getline(mounts, rest)) {
+        if (type == "hugetlbfs") return path;
+    }
+    return "";
+}
+
+// Upper bound (ns) of the bucket holding the given fraction of samples.
+inline uint64_t latency_percentile(const std::atomic<uint64_t> *buckets, double fraction) {
+    uint64_t total = 0;
+    for (size_t b = 0; b < LATENCY_BUCKETS; b++) total += buckets[b].load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+
+    uint64_t seen = 0;
+    for (size_t b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += buckets[b].load(std::memory_order_relaxed);
+        if (seen >= fraction * total) return uint64_t(1) << b;
+    }
+    return uint64_t(1) << (LATENCY_BUCKETS - 1);
+}
+
+template <size_t MaxConsumers>
+void print_metrics(const ChannelMetrics<MaxConsumers> &m, const std::atomic<uint64_t> &active_mask,
+                   uint64_t head, const std::atomic<uint64_t> *tails) {
+    std::cout << "Published: " << m.published.load(std::memory_order_relaxed)
+              << " | Aborted: " << m.aborted.load(std::memory_order_relaxed)
+              << " | Blocked: " << m.blocked.load(std::memory_order_relaxed)
+              << " (" << m.blocked_ns.load(std::memory_order_relaxed) / 1000000 << "ms)"
+              << " | Kicked: " << m.kicked.load(std::memory_order_relaxed)
+              << " | Recovered: " << m.recovered.load(std::memory_order_relaxed) << std::endl;
+    std::cout << "Latency (sampled, <=): p50 " << latency_percentile(m.latency, 0.5)
+              << "ns | p99 " << latency_percentile(m.latency, 0.99)
+              << "ns | p99.9 " << latency_percentile(m.latency, 0.999) << "ns" << std::endl;
+
+    for (size_t i = 0; i < MaxConsumers; i++) {
+        if (!is_active(active_mask, i)) continue;
+        const ConsumerMetrics &c = m.consumers[i];
+        std::cout << "  [ID " << i << "] Lag: " << (head - tails[i].load(std::memory_order_relaxed))
+                  << " | Consumed: " << c.consumed.load(std::memory_order_relaxed)
+                  << " | Overwritten: " << c.overwritten.load(std::memory_order_relaxed)
+                  << " | Lap retries: " << c.lap_retries.load(std::memory_order_relaxed)
+                  << " | Ready timeouts: " << c.ready_timeouts.load(std::memory_order_relaxed)
+                  << " | Epoch resets: " << c.epoch_resets.load(std::memory_order_relaxed)
+                  << " | Conflated: " << c.conflated.load(std::memory_order_relaxed)
+                  << " | Torn reads: " << c.torn_reads.load(std::memory_order_relaxed) << std::endl;
+    }
+}
+
+} // namespace detail
+
+// Owns one named shared memory mapping. Segments normally live in /dev/shm;
+// with settings.huge_pages the creator places them on hugetlbfs instead,
+// falling back to transparent huge pages when no pool is available.
+// Attaching processes look in /dev/shm first, then on hugetlbfs.
+class SharedSegment {
+    int fd = -1;
+    void *base = nullptr;
+    size_t length = 0;
+
+    static size_t page_size_of(int fd) {
+        struct statfs fs;
+        if (fstatfs(fd, &fs) == 0 && fs.f_bsize > 0) return static_cast<size_t>(fs.f_bsize);
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    static std::string hugetlbfs_path(const std::string &name) {
+        std::string mount = detail::hugetlbfs_mount();
+        return mount.empty() ? "" : mount + name;
+    }
+
+    void close_fd() {
+        if (fd != -1) ::close(fd);
+        fd = -1;
+    }
+
+    // Creates the segment on hugetlbfs. Returns false (leaving nothing
+    // behind) if there is no mount or the huge page pool is too small.
+    bool create_hugetlbfs(const std::string &name, size_t size) {
+        std::string path = hugetlbfs_path(name);
+        if (path.empty()) return false;
+
+        fd = ::open(path.c_str(), O_CREAT | O_RDWR, 0666);
+        if (fd == -1) return false;
+
+        size_t page = page_size_of(fd);
+        length = (size + page - 1) / page * page;
+        if (ftruncate(fd, length) == 0) {
+            base = mmap(0, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base != MAP_FAILED) return true;
+        }
+
+        base = nullptr;
+        close_fd();
+        ::unlink(path.c_str());
+        return false;
+    }
+
+public:
+    SharedSegment() = default;
+    SharedSegment(const SharedSegment &) = delete;
+    SharedSegment &operator=(const SharedSegment &) = delete;
+
+    ~SharedSegment() { close(); }
+
+    void close() {
+        if (base) munmap(base, length);
+        base = nullptr;
+        length = 0;
+        close_fd();
+    }
+
+    void *data() const { return base; }
+    size_t size() const { return length; }
+
+    // `name` carries the leading '/' expected by shm_open.
+    void open(const std::string &name, size_t size, bool create, const BrokerSettings &settings) {
+        bool huge = false;
+
+        if (create) {
+            unlink(name);
+
+            huge = settings.huge_pages && create_hugetlbfs(name, size);
+            if (settings.huge_pages && !huge) {
+                std::cerr << "[NanoBroker] hugetlbfs unavailable, using transparent huge pages" << std::endl;
+            }
+
+            if (!huge) {
+                fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
+                if (fd == -1) throw std::runtime_error("Failed to create shared memory");
+                size_t page = page_size_of(fd);
+                length = (size + page - 1) / page * page;
+                if (ftruncate(fd, length) == -1)
+                    throw std::runtime_error("Resize failed");
+            }
+        } else {
+            fd = shm_open(name.c_str(), O_RDWR, 0666);
+            if (fd == -1) {
+                std::string path = hugetlbfs_path(name);
+                if (!path.empty()) fd = ::open(path.c_str(), O_RDWR);
+                huge = (fd != -1);
+            }
+            if (fd == -1) throw std::runtime_error("Failed to open shared memory (Producer not running?)");
+
+            // Catch layout mismatches here instead of with a SIGBUS later.
+            struct stat st;
+            if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < size)
+                throw std::runtime_error("Segment smaller than expected (BufferSize/struct mismatch?)");
+            size_t page = page_size_of(fd);
+            length = (size + page - 1) / page * page;
+        }
+
+        if (!base) {
+            // Attachers can populate immediately. The creator maps lazily so
+            // the NUMA policy below is in place before any page is faulted.
+            int flags = MAP_SHARED | ((settings.prefault && !create) ? MAP_POPULATE : 0);
+            base = mmap(0, length, PROT_READ | PROT_WRITE, flags, fd, 0);
+            if (base == MAP_FAILED) { base = nullptr; throw std::runtime_error("mmap failed"); }
+        }
+
+        if (!huge && settings.huge_pages) madvise(base, length, MADV_HUGEPAGE);
+
+        if (create && settings.numa_node >= 0) {
+            unsigned long nodemask[16] = {0};
+            size_t bits = sizeof(nodemask) * 8;
+            if (static_cast<size_t>(settings.numa_node) < bits) {
+                nodemask[settings.numa_node / (8 * sizeof(unsigned long))] |=
+                    1UL << (settings.numa_node % (8 * sizeof(unsigned long)));
+            }
+            if (syscall(SYS_mbind, base, length, MPOL_BIND, nodemask, bits + 1, MPOL_MF_MOVE) != 0) {
+                std::cerr << "[NanoBroker] NUMA bind to node " << settings.numa_node
+                          << " failed: " << std::strerror(errno) << std::endl;
+            }
+        }
+
+        if (create && settings.prefault) {
+            size_t page = page_size_of(fd);
+            volatile uint8_t *bytes = static_cast<uint8_t *>(base);
+            for (size_t off = 0; off < length; off += page) bytes[off] = 0;
+        }
+
+        if (settings.lock_memory && mlock(base, length) != 0) {
+            std::cerr << "[NanoBroker] mlock failed: " << std::strerror(errno) << std::endl;
+        }
+    }
+
+    static void unlink(const std::string &name) {
+        shm_unlink(name.c_str());
+        std::string path = hugetlbfs_path(name);
+        if (!path.empty()) ::unlink(path.c_str());
+    }
+};
+
+// First bytes of every segment. Besides identifying the channel it records
+// where each shared section lives, so tools can inspect any topic without
+// the producer's template arguments (see SegmentInspector). Offsets are in
+// bytes from the start of the segment.
+struct alignas(64) SegmentHeader {
+    uint64_t magic;
+    uint32_t version;
+    ChannelKind kind;
+    uint32_t struct_size;     // sizeof(T); 0 for BYTES
+    uint32_t buffer_capacity; // Slots (FIXED) or arena bytes (BYTES)
+    uint32_t max_consumers;
+    uint32_t slot_stride;     // Bytes between slots; 0 for BYTES
+    uint64_t producer_epoch;
+    uint64_t segment_size;
+
+    uint64_t head_offset;
+    uint64_t tails_offset;
+    uint64_t active_mask_offset;
+    uint64_t heartbeats_offset;
+    uint64_t metrics_offset;
+    uint64_t data_offset;     // Slot array or arena; everything before it is control data
+};
+
+namespace detail {
+
+// Fills in the layout part of a freshly created channel's header.
+template <typename Channel>
+void describe_layout(Channel *channel, ChannelKind kind, uint32_t max_consumers, uint32_t slot_stride,
+                     const void *data) {
+    const uint8_t *base = reinterpret_cast<const uint8_t *>(channel);
+    auto offset = [base](const void *field) {
+        return static_cast<uint64_t>(reinterpret_cast<const uint8_t *>(field) - base);
+    };
+
+    SegmentHeader &h = channel->header;
+    h.kind = kind;
+    h.max_consumers = max_consumers;
+    h.slot_stride = slot_stride;
+    h.segment_size = sizeof(Channel);
+    h.head_offset = offset(&channel->head);
+    h.tails_offset = offset(&channel->tails[0]);
+    h.active_mask_offset = offset(&channel->active_mask);
+    h.heartbeats_offset = offset(&channel->heartbeats[0]);
+    h.metrics_offset = offset(&channel->metrics);
+    h.data_offset = offset(data);
+}
+
+} // namespace detail
+
 template <typename T> void validate_type() {
     static_assert(std::is_trivially_copyable<T>::value,
                   "NanoBroker Error: Data type must be POD.");
 }
 
+// Leading bytes of a T that hold data. Specialise it for types with a large
+// fixed-capacity buffer (e.g. pixels) so relays and recorders copy only the
+// filled part. Results above sizeof(T) are clamped by callers.
+template <typename T> struct PayloadTraits {
+    static size_t size(const T &) { return sizeof(T); }
+};
+
+template <typename T> size_t payload_size(const T &value) {
+    size_t bytes = PayloadTraits<T>::size(value);
+    return bytes < sizeof(T) ? bytes : sizeof(T);
+}
+
 
+// `sequence` holds (claim number + 1) of the last commit into this slot, so
+// a consumer at tail t knows the slot is ready once sequence == t + 1.
 template <typename T>
 struct alignas(64) SlotWrapper {
     std::atomic<uint64_t> sequence{0};   
     std::atomic<SlotState> state{SlotState::FREE}; 
+    std::atomic<int32_t> writer_pid{0}; // Process filling the slot; 0 once committed
+    int64_t commit_ns = 0; // Non-zero on sampled commits (see LATENCY_SAMPLE_MASK)
     T data;
 };
 
 template <typename T, size_t BufferSize, size_t MaxConsumers>
 struct alignas(64) SharedChannel {
 
-    uint64_t magic;
-    uint32_t version;
-    uint32_t struct_size;
-    uint32_t buffer_capacity;
-    uint64_t producer_epoch;
-    
-    alignas(64) std::atomic<size_t> head;
-    alignas(64) std::atomic<size_t> tails[MaxConsumers];
-    alignas(64) std::atomic<bool> slot_active[MaxConsumers];
+    SegmentHeader header;
+
+    // Head is the next claim number, tails the next claim number each
+    // consumer will read. Both grow monotonically; slot = number % BufferSize.
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tails[MaxConsumers];
+    alignas(64) std::atomic<uint64_t> active_mask; // Bit i set = consumer i attached
     alignas(64) std::atomic<int64_t> heartbeats[MaxConsumers];
-    alignas(64) std::atomic_flag write_lock = ATOMIC_FLAG_INIT;
+    alignas(64) std::atomic<int32_t> owner_pids[MaxConsumers]; // Process holding each ID
+    alignas(64) ChannelSignal signal;
+    alignas(64) ChannelMetrics<MaxConsumers> metrics;
 
     alignas(64) SlotWrapper<T> slots[BufferSize];
 };
 
+// Consecutive ready slots returned by Broker::peek_batch(). Slots are not
+// contiguous in memory (they wrap and carry headers), so this is an
+// indexable view rather than a raw pointer range.
+template <typename T>
+class SlotBatch {
+    const SlotWrapper<T> *slots;
+    size_t capacity;
+    uint64_t first;
+    size_t count;
+
+public:
+    SlotBatch(const SlotWrapper<T> *slots, size_t capacity, uint64_t first, size_t count)
+        : slots(slots), capacity(capacity), first(first), count(count) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    uint64_t first_sequence() const { return first; }
+    const T &operator[](size_t i) const { return slots[(first + i) % capacity].data; }
+
+    class iterator {
+        const SlotBatch *batch;
+        size_t index;
+    public:
+        iterator(const SlotBatch *batch, size_t index) : batch(batch), index(index) {}
+        const T &operator*() const { return (*batch)[index]; }
+        iterator &operator++() { ++index; return *this; }
+        bool operator!=(const iterator &other) const { return index != other.index; }
+    };
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, count); }
+};
+
 template <size_t N>
 struct NanoString {
     char buffer[N];
@@ -81,63 +731,139 @@ struct NanoString {
 
 template <typename T, size_t BufferSize = 30, size_t MaxConsumers = 16>
 class Broker {
+    static_assert(MaxConsumers <= 64, "MaxConsumers is limited by the 64-bit active mask");
+
 private:
     std::string name;
-    int shm_fd;
+    SharedSegment segment;
     SharedChannel<T, BufferSize, MaxConsumers> *channel;
     bool is_owner;
     int consumer_id;
     uint64_t local_epoch_cache = 0;
     BrokerSettings settings;
     SlotWrapper<T>* pending_slot = nullptr; 
+    uint64_t pending_seq = 0;
+    uint64_t cached_min_tail = 0; // Lower bound on every active tail
+    uint64_t read_tail = 0;       // Tail at the last peek()/peek_batch()
+    size_t peeked = 0;            // Entries from read_tail not released yet
+    uint64_t sampled_tail = UINT64_MAX; // Last tail fed to the latency histogram
+    int64_t blocked_since = 0;    // When prepare_publish() first got refused
+    int64_t last_heartbeat = 0;   // Coarse tick of our last heartbeat store
+    int64_t last_liveness_check = 0; // Coarse tick of our last stalled-writer check
+    int32_t self_pid = static_cast<int32_t>(getpid());
+
+    int64_t now_ms() const { return detail::coarse_now_ms(); }
+
+    // Rescans the active consumers for `claim`: kicks stale ones, pushes
+    // laggards under OVERWRITE_OLD and recomputes cached_min_tail. Returns
+    // false if a consumer blocks the claim under BLOCK.
+    bool refresh_min_tail(uint64_t claim, int64_t timeout_ms) {
+        int64_t now = now_ms();
+        uint64_t min_tail = claim;
+        uint64_t mask = channel->active_mask.load(std::memory_order_acquire);
+
+        while (mask) {
+            size_t i = __builtin_ctzll(mask);
+            mask &= mask - 1;
+
+            uint64_t t = channel->tails[i].load(std::memory_order_acquire);
+            if (claim >= t + BufferSize) {
+                int64_t last = channel->heartbeats[i].load(std::memory_order_relaxed);
+                if ((now - last) > timeout_ms) {
+                    channel->active_mask.fetch_and(~detail::consumer_bit(i), std::memory_order_release);
+                    channel->metrics.kicked.fetch_add(1, std::memory_order_relaxed);
+                    std::cerr << "[NanoBroker] Auto-kicked consumer " << i << std::endl;
+                    continue;
+                }
+
+                if (settings.overflow_policy == OverflowPolicy::BLOCK) return false;
+
+                // Push the lagging consumer just past the slot we are about
+                // to reuse. A failed CAS reloads t; retry until it is clear.
+                while (claim >= t + BufferSize &&
+                       !channel->tails[i].compare_exchange_weak(t, claim - BufferSize + 1,
+                                                                std::memory_order_acq_rel)) {
+                }
+                if (claim >= t + BufferSize) {
+                    channel->metrics.consumers[i].overwritten.fetch_add(claim - BufferSize + 1 - t,
+                                                                        std::memory_order_relaxed);
+                    t = claim - BufferSize + 1;
+                }
+            }
+            if (t < min_tail) min_tail = t;
+        }
+
+        cached_min_tail = min_tail;
+        return true;
+    }
+
+    // Epoch check, liveness check and heartbeat shared by the read paths.
+    // Returns false when the producer restarted and the tail was reset.
+    bool begin_read() {
+
+        uint64_t current_epoch = channel->header.producer_epoch; 
+        
+
+        if (local_epoch_cache == 0) local_epoch_cache = current_epoch;
+
+
+        if (current_epoch != local_epoch_cache) {
+            std::cerr << "[NanoBroker] Producer restarted! Resetting tail." << std::endl;
+    
+            uint64_t new_head = channel->head.load(std::memory_order_relaxed);
+            channel->tails[consumer_id].store(new_head, std::memory_order_release);
+            detail::count_local(channel->metrics.consumers[consumer_id].epoch_resets);
+            local_epoch_cache = current_epoch;
+            return false; 
+        }
 
-    int64_t now_ms() const {
-        return std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now().time_since_epoch()).count();
+        require_consumer_id();
+        detail::touch_heartbeat(channel->heartbeats[consumer_id], last_heartbeat);
+        return true;
+    }
+
+    // Throws once this process no longer holds consumer_id, so a kicked
+    // consumer can never move the tail of whoever claimed the ID next.
+    void require_consumer_id() const {
+        if (!detail::holds_consumer_id(channel->active_mask, channel->owner_pids, consumer_id, self_pid)) {
+            throw std::runtime_error("Consumer disconnected.");
+        }
     }
 
 public:
     Broker(const std::string &channel_name, bool create = false, int id = 0,
            BrokerSettings custom_settings = BrokerSettings())
-        : name("/" + channel_name), shm_fd(-1), channel(nullptr),
+        : name("/" + channel_name), channel(nullptr),
           is_owner(create), consumer_id(create ? -1 : id), settings(custom_settings)
     {
         validate_type<T>();
 
-        if (create) {
-            
-            shm_unlink(name.c_str());
-
-            shm_fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
-            if (shm_fd == -1) throw std::runtime_error("Failed to create shared memory");
-            if (ftruncate(shm_fd, sizeof(SharedChannel<T, BufferSize, MaxConsumers>)) == -1)
-                throw std::runtime_error("Resize failed");
-        } else {
-            shm_fd = shm_open(name.c_str(), O_RDWR, 0666);
-            if (shm_fd == -1) throw std::runtime_error("Failed to open shared memory (Producer not running?)");
-        }
-
-        void *ptr = mmap(0, sizeof(SharedChannel<T, BufferSize, MaxConsumers>),
-                         PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-        if (ptr == MAP_FAILED) throw std::runtime_error("mmap failed");
-
-        channel = static_cast<SharedChannel<T, BufferSize, MaxConsumers> *>(ptr);
+        // Thread placement first, so the pages below are faulted from the
+        // chosen CPU. Only broker constructors do this, once each.
+        detail::apply_thread_settings(settings);
+        segment.open(name, sizeof(SharedChannel<T, BufferSize, MaxConsumers>), create, settings);
+        channel = static_cast<SharedChannel<T, BufferSize, MaxConsumers> *>(segment.data());
 
         if (create) {
-            channel->magic = MAGIC_NUMBER;
-            channel->version = PROTOCOL_VERSION;
+            channel->header.magic = MAGIC_NUMBER;
+            channel->header.version = PROTOCOL_VERSION;
             std::random_device rd;
             std::mt19937_64 gen(rd());
             std::uniform_int_distribution<uint64_t> dis;
-            channel->producer_epoch = dis(gen);
-            channel->struct_size = sizeof(T);
-            channel->buffer_capacity = BufferSize;
+            channel->header.producer_epoch = dis(gen);
+            channel->header.struct_size = sizeof(T);
+            channel->header.buffer_capacity = BufferSize;
+            detail::describe_layout(channel, ChannelKind::FIXED, MaxConsumers, sizeof(SlotWrapper<T>),
+                                    channel->slots);
 
-            new (&channel->head) std::atomic<size_t>(0);
+            new (&channel->head) std::atomic<uint64_t>(0);
+            new (&channel->signal) ChannelSignal();
+            new (&channel->active_mask) std::atomic<uint64_t>(0);
+            new (&channel->metrics) ChannelMetrics<MaxConsumers>();
             for (size_t i = 0; i < MaxConsumers; i++) {
-                new (&channel->tails[i]) std::atomic<size_t>(0);
-                new (&channel->slot_active[i]) std::atomic<bool>(false);
+                new (&channel->tails[i]) std::atomic<uint64_t>(0);
                 new (&channel->heartbeats[i]) std::atomic<int64_t>(0);
+                new (&channel->owner_pids[i]) std::atomic<int32_t>(0);
             }
    
             for(size_t i=0; i<BufferSize; i++) {
@@ -146,194 +872,497 @@ public:
             }
         } else {
     
-            if (channel->magic != MAGIC_NUMBER) throw std::runtime_error("SHM Magic Mismatch! (Old/Corrupt Memory)");
-            if (channel->version != PROTOCOL_VERSION) throw std::runtime_error("Protocol Version Mismatch!");
-            if (channel->struct_size != sizeof(T)) throw std::runtime_error("Data Struct Size Mismatch!");
+            const SegmentHeader &header = channel->header;
+            if (header.magic != MAGIC_NUMBER) throw std::runtime_error("SHM Magic Mismatch! (Old/Corrupt Memory)");
+            if (header.version != PROTOCOL_VERSION) throw std::runtime_error("Protocol Version Mismatch!");
+            if (header.kind != ChannelKind::FIXED) throw std::runtime_error("Channel is not a fixed-slot channel!");
+            if (header.struct_size != sizeof(T)) throw std::runtime_error("Data Struct Size Mismatch!");
+            if (header.buffer_capacity != BufferSize) throw std::runtime_error("Buffer Size Mismatch!");
+            if (header.max_consumers != MaxConsumers) throw std::runtime_error("Max Consumers Mismatch!");
 
             if (id != -99) {
-                if (consumer_id < 0 || consumer_id >= static_cast<int>(MaxConsumers)) {
-                    throw std::runtime_error("Invalid Consumer ID");
-                }
-            
-                size_t h = channel->head.load(std::memory_order_relaxed);
+                consumer_id = detail::claim_consumer_id(channel->active_mask, channel->heartbeats,
+                                                        channel->owner_pids, MaxConsumers, id,
+                                                        settings.producer_timeout_ms);
+
+                uint64_t h = channel->head.load(std::memory_order_relaxed);
                 channel->tails[consumer_id].store(h, std::memory_order_release);
-                channel->heartbeats[consumer_id].store(now_ms(), std::memory_order_release);
-                channel->slot_active[consumer_id].store(true, std::memory_order_release);
+                new (&channel->metrics.consumers[consumer_id]) ConsumerMetrics();
             }
         }
     }
 
     ~Broker() {
         if (!is_owner && channel && consumer_id != -99) {
-            channel->slot_active[consumer_id].store(false, std::memory_order_release);
+            detail::release_consumer_id(channel->active_mask, channel->owner_pids, consumer_id);
         }
-        if (channel) munmap(channel, sizeof(SharedChannel<T, BufferSize, MaxConsumers>));
-        if (shm_fd != -1) close(shm_fd);
         
     }
 
+    // The consumer ID in use (useful with AUTO_ID); -1 for the creator.
+    int id() const { return consumer_id; }
+
 
 
+    // A claimed slot that stays open alongside others. Tickets let one
+    // producer keep several slots in flight at once, e.g. buffers queued to
+    // a capture driver, and commit them in any order.
+    struct Ticket {
+        T *data = nullptr;
+        uint64_t claim = 0;
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    // Claims the next slot without a lock: producers race on a CAS of
+    // `head`, fill their slots in parallel and may commit out of order.
+    // Consumers still see slots in claim order via the slot sequence.
     T *prepare_publish(int64_t timeout_ms = 2000) {
+        if (pending_slot) return &pending_slot->data;
 
-        while (channel->write_lock.test_and_set(std::memory_order_acquire)) { _mm_pause(); }
+        uint64_t claim;
+        SlotWrapper<T> *slot = claim_slot(claim, timeout_ms, SlotState::WRITING);
+        if (!slot) return nullptr;
 
-        size_t current_head = channel->head.load(std::memory_order_relaxed);
-        size_t next_head = (current_head + 1) % BufferSize;
-        int64_t now = now_ms();
-        bool full = false;
-
-
-        for (size_t i = 0; i < MaxConsumers; i++) {
-            if (channel->slot_active[i].load(std::memory_order_relaxed)) {
-                size_t t = channel->tails[i].load(std::memory_order_acquire);
-                if (next_head == t) {
-           
-                    int64_t last = channel->heartbeats[i].load(std::memory_order_relaxed);
-                    if ((now - last) > timeout_ms) {
-                        channel->slot_active[i].store(false, std::memory_order_release);
-                        std::cerr << "[NanoBroker] Auto-kicked consumer " << i << std::endl;
-                        continue; 
-                    }
-                    
-                    if (settings.overflow_policy == OverflowPolicy::BLOCK) {
-                        full = true; break;
-                    } else {
-                        channel->tails[i].store((t + 1) % BufferSize, std::memory_order_release);
-                    }
-                }
+        pending_slot = slot;
+        pending_seq = claim;
+        return &slot->data;
+    }
+
+    void commit_publish() {
+        if (!pending_slot) return;
+        finish_slot(pending_slot, pending_seq, SlotState::READY);
+        pending_slot = nullptr;
+    }
+
+    // Claims a slot as a ticket; independent of prepare_publish(). Consumers
+    // that reach a QUEUED slot return nullptr at once instead of spinning
+    // for it. Keep fewer than BufferSize tickets open: a claim one lap ahead
+    // waits for the slot's previous ticket. Returns an empty ticket if the
+    // claim fails.
+    Ticket claim(int64_t timeout_ms = 2000) {
+        Ticket ticket;
+        SlotWrapper<T> *slot = claim_slot(ticket.claim, timeout_ms, SlotState::QUEUED);
+        if (slot) ticket.data = &slot->data;
+        return ticket;
+    }
+
+    void commit(const Ticket &ticket) {
+        if (!ticket) return;
+        finish_slot(&channel->slots[ticket.claim % BufferSize], ticket.claim, SlotState::READY);
+    }
+
+    void abort(const Ticket &ticket) {
+        if (!ticket) return;
+        finish_slot(&channel->slots[ticket.claim % BufferSize], ticket.claim, SlotState::ABORTED);
+    }
+
+private:
+    SlotWrapper<T> *claim_slot(uint64_t &claim, int64_t timeout_ms, SlotState state) {
+        claim = channel->head.load(std::memory_order_relaxed);
+
+        // Fast path: while the claim stays within one lap of the cached
+        // slowest tail no consumer state is touched at all.
+        do {
+            if (claim >= cached_min_tail + BufferSize && !refresh_min_tail(claim, timeout_ms)) {
+                channel->metrics.blocked.fetch_add(1, std::memory_order_relaxed);
+                if (blocked_since == 0) blocked_since = detail::now_ns();
+                return nullptr;
             }
+        } while (!channel->head.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel,
+                                                      std::memory_order_relaxed));
+
+        if (blocked_since != 0) {
+            channel->metrics.blocked_ns.fetch_add(detail::now_ns() - blocked_since, std::memory_order_relaxed);
+            blocked_since = 0;
         }
 
-        if (full) {
-            channel->write_lock.clear(std::memory_order_release);
-            return nullptr;
+        SlotWrapper<T> *slot = &channel->slots[claim % BufferSize];
+
+        // A producer one lap behind may still be filling this slot, or may
+        // have died doing so.
+        uint64_t previous = claim >= BufferSize ? claim - BufferSize + 1 : 0;
+        for (uint32_t spin = 1; slot->sequence.load(std::memory_order_acquire) != previous; spin++) {
+            _mm_pause();
+            if ((spin & 1023) == 0) recover_slot(slot);
         }
 
-        pending_slot = &channel->slots[current_head];
-        pending_slot->state.store(SlotState::WRITING, std::memory_order_release);
-        
-        return &pending_slot->data;
+        slot->writer_pid.store(self_pid, std::memory_order_relaxed);
+        slot->state.store(state, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return slot;
     }
 
-void commit_publish() {
-        if (!pending_slot) return;
+    // Commits claim `claim` as READY or ABORTED.
+    void finish_slot(SlotWrapper<T> *slot, uint64_t claim, SlotState state) {
+        bool ready = state == SlotState::READY;
+        slot->commit_ns = (ready && (claim & LATENCY_SAMPLE_MASK) == 0) ? detail::now_ns() : 0;
+        slot->state.store(state, std::memory_order_relaxed);
+        slot->writer_pid.store(0, std::memory_order_relaxed);
+        slot->sequence.store(claim + 1, std::memory_order_release);
 
-        size_t current_head = channel->head.load(std::memory_order_relaxed);
-        
+        (ready ? channel->metrics.published : channel->metrics.aborted).fetch_add(1, std::memory_order_relaxed);
 
-        
-        uint64_t seq = pending_slot->sequence.load(std::memory_order_relaxed);
-        pending_slot->sequence.store(seq + 1, std::memory_order_release);
+        detail::notify_publish(channel->signal);
+    }
 
-        pending_slot->state.store(SlotState::READY, std::memory_order_release);
-        
-        size_t next_head = (current_head + 1) % BufferSize;
-        channel->head.store(next_head, std::memory_order_release);
-        
-        channel->write_lock.clear(std::memory_order_release); 
+    // Commits the in-flight claim of `slot` as ABORTED if the process that
+    // claimed it has died, so neither consumers nor the next lap's producer
+    // wait on it forever. Whatever it half-wrote is never shown. The pid CAS
+    // picks one recoverer when several notice at once. A process that dies
+    // after claiming but before recording its pid (while waiting on a
+    // previous lap) is not detected.
+    bool recover_slot(SlotWrapper<T> *slot) {
+        int32_t writer = slot->writer_pid.load(std::memory_order_acquire);
+        if (!detail::process_gone(writer)) return false;
+        if (!slot->writer_pid.compare_exchange_strong(writer, 0, std::memory_order_acq_rel)) return false;
+
+        // The stuck claim is one lap past the slot's last commit.
+        uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+        uint64_t claim = seq == 0 ? static_cast<uint64_t>(slot - channel->slots) : seq - 1 + BufferSize;
+        slot->commit_ns = 0;
+        slot->state.store(SlotState::ABORTED, std::memory_order_relaxed);
+        slot->sequence.store(claim + 1, std::memory_order_release);
+
+        channel->metrics.recovered.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "[NanoBroker] Rolled back slot " << claim << " left by dead process " << writer << std::endl;
+        detail::notify_publish(channel->signal);
+        return true;
+    }
+
+    // recover_slot() for the read path, at most once per coarse tick.
+    bool recover_stalled(SlotWrapper<T> *slot) {
+        int64_t now = now_ms();
+        if (now == last_liveness_check) return false;
+        last_liveness_check = now;
+        return recover_slot(slot);
+    }
+
+public:
+
+    // Claims a slot, copies the first `bytes` of `src` into it (e.g. a frame
+    // header plus only the used part of its payload) and commits. Large
+    // copies use non-temporal stores. Returns false if the claim fails.
+    bool publish_from(const T &src, size_t bytes = sizeof(T), int64_t timeout_ms = 2000) {
+        if (bytes > sizeof(T)) throw std::out_of_range("publish_from: size exceeds slot");
+        T *slot = prepare_publish(timeout_ms);
+        if (!slot) return false;
+        detail::stream_copy(slot, &src, bytes);
+        commit_publish();
+        return true;
+    }
+
+    // Gives up a claimed slot without publishing its contents. The claim
+    // number is still consumed, so the slot is committed as ABORTED and
+    // consumers skip it.
+    void abort_publish() {
+        if (!pending_slot) return;
+        finish_slot(pending_slot, pending_seq, SlotState::ABORTED);
         pending_slot = nullptr;
     }
 
 
 
     const T *peek() {
+        peeked = 0;
+        if (!begin_read()) return nullptr;
 
-        uint64_t current_epoch = channel->producer_epoch; 
-        
+        int spin = 0;
+        while (true) {
+            uint64_t current_tail = channel->tails[consumer_id].load(std::memory_order_acquire);
+            if (current_tail == channel->head.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
 
-        if (local_epoch_cache == 0) local_epoch_cache = current_epoch;
+            auto* slot = &channel->slots[current_tail % BufferSize];
+            uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+
+            if (seq == current_tail + 1) {
+                SlotState state = slot->state.load(std::memory_order_acquire);
+                if (state == SlotState::READY) {
+                    if (slot->commit_ns != 0 && sampled_tail != current_tail) {
+                        detail::record_latency(channel->metrics.latency, slot->commit_ns);
+                        sampled_tail = current_tail;
+                    }
+                    read_tail = current_tail;
+                    peeked = 1;
+                    return &slot->data;
+                }
+                if (state == SlotState::ABORTED) {
+                    channel->tails[consumer_id].compare_exchange_strong(current_tail, current_tail + 1,
+                                                                        std::memory_order_acq_rel);
+                    continue;
+                }
+            }
 
+            if (seq > current_tail + 1) {
+                // Lapped by the producer: this frame is gone, step past it.
+                detail::count_local(channel->metrics.consumers[consumer_id].lap_retries);
+                channel->tails[consumer_id].compare_exchange_strong(current_tail, current_tail + 1,
+                                                                    std::memory_order_acq_rel);
+                continue;
+            }
 
-        if (current_epoch != local_epoch_cache) {
-            std::cerr << "[NanoBroker] Producer restarted! Resetting tail." << std::endl;
-    
-            size_t new_head = channel->head.load(std::memory_order_relaxed);
-            channel->tails[consumer_id].store(new_head, std::memory_order_release);
-            local_epoch_cache = current_epoch;
-            return nullptr; 
+            // Claimed but not committed yet (possibly out of order). A
+            // ticket may stay open for a whole frame period: don't spin.
+            // Either way the writer may be dead, in which case the slot is
+            // rolled back and skipped.
+            if (slot->state.load(std::memory_order_relaxed) == SlotState::QUEUED) {
+                if (recover_stalled(slot)) continue;
+                return nullptr;
+            }
+            _mm_pause();
+            if (++spin > 10000) {
+                detail::count_local(channel->metrics.consumers[consumer_id].ready_timeouts);
+                if (recover_stalled(slot)) { spin = 0; continue; }
+                return nullptr;
+            }
         }
+    }
 
-        if (!channel->slot_active[consumer_id].load(std::memory_order_relaxed)) {
-            throw std::runtime_error("Consumer disconnected.");
-        }
-        channel->heartbeats[consumer_id].store(now_ms(), std::memory_order_relaxed);
+    // Jumps straight to the newest committed frame, skipping everything
+    // older. The tail is moved to that frame before it is returned, so a BLOCK
+    // producer cannot reuse it and slow readers never hold the ring back.
+    // release() then consumes it as usual.
+    const T *peek_latest() {
+        peeked = 0;
+        if (!begin_read()) return nullptr;
+
+        while (true) {
+            uint64_t current_tail = channel->tails[consumer_id].load(std::memory_order_acquire);
+            uint64_t h = channel->head.load(std::memory_order_acquire);
+            if (current_tail == h) return nullptr;
+
+            // Usually h - 1 is ready and this is one probe; it only walks back
+            // past in-flight or aborted claims.
+            uint64_t oldest = (h - current_tail > BufferSize) ? h - BufferSize : current_tail;
+            uint64_t n = h;
+            SlotWrapper<T> *slot = nullptr;
+            while (n > oldest) {
+                n--;
+                auto *candidate = &channel->slots[n % BufferSize];
+                if (candidate->sequence.load(std::memory_order_acquire) == n + 1 &&
+                    candidate->state.load(std::memory_order_acquire) == SlotState::READY) {
+                    slot = candidate;
+                    break;
+                }
+            }
 
-        size_t current_tail = channel->tails[consumer_id].load(std::memory_order_relaxed);
-        if (current_tail == channel->head.load(std::memory_order_acquire)) {
-            return nullptr;
+            if (!slot || n == current_tail) return peek();
+
+            if (!channel->tails[consumer_id].compare_exchange_strong(current_tail, n, std::memory_order_acq_rel)) {
+                continue;
+            }
+            // Without BLOCK the producer may have lapped the slot before the
+            // tail move; re-validate the sequence.
+            if (slot->sequence.load(std::memory_order_acquire) != n + 1) continue;
+
+            detail::count_local(channel->metrics.consumers[consumer_id].conflated, n - current_tail);
+            if (slot->commit_ns != 0 && sampled_tail != n) {
+                detail::record_latency(channel->metrics.latency, slot->commit_ns);
+                sampled_tail = n;
+            }
+            read_tail = n;
+            peeked = 1;
+            return &slot->data;
         }
+    }
 
-        auto* slot = &channel->slots[current_tail];
-        
-      
-        uint64_t seq_before = slot->sequence.load(std::memory_order_acquire);
+    // True if the frame returned by the last peek()/peek_latest() has not been
+    // reclaimed by a producer since. Call it after copying out of the frame:
+    // a true result means the copy is consistent (seqlock read check). Only
+    // OVERWRITE_OLD can make it false; under BLOCK the tail protects the slot.
+    bool peek_valid() {
+        require_consumer_id();
+        const auto &slot = channel->slots[read_tail % BufferSize];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.state.load(std::memory_order_relaxed) == SlotState::READY &&
+            slot.sequence.load(std::memory_order_relaxed) == read_tail + 1) return true;
 
- 
-        int spin = 0;
-        while (slot->state.load(std::memory_order_acquire) != SlotState::READY) {
-            _mm_pause();
-            if (++spin > 10000) return nullptr;
+        detail::count_local(channel->metrics.consumers[consumer_id].torn_reads);
+        return false;
+    }
+
+    // Copy-out read: copies `bytes` of the next frame starting at `offset`
+    // into dst, validates the copy and consumes the frame. A copy torn by an
+    // overwriting producer is discarded and the next frame tried. Returns
+    // false if nothing is ready.
+    bool read_into(void *dst, size_t bytes, size_t offset = 0) {
+        if (offset > sizeof(T) || bytes > sizeof(T) - offset)
+            throw std::out_of_range("read_into: range exceeds slot");
+
+        while (const T *frame = peek()) {
+            detail::stream_copy(dst, reinterpret_cast<const uint8_t *>(frame) + offset, bytes);
+            if (peek_valid()) {
+                release();
+                return true;
+            }
         }
+        return false;
+    }
 
+    bool read_into(T &dst) { return read_into(&dst, sizeof(T)); }
 
-        uint64_t seq_after = slot->sequence.load(std::memory_order_acquire);
+    // Returns up to max_n consecutive ready slots starting at this consumer's
+    // tail, validated in one pass with a single epoch check and heartbeat.
+    // Stops early at the first slot that is not committed yet.
+    SlotBatch<T> peek_batch(size_t max_n) {
+        if (max_n > BufferSize) max_n = BufferSize;
+        peeked = 0;
+        if (!begin_read()) return SlotBatch<T>(channel->slots, BufferSize, 0, 0);
 
-        if (seq_before != seq_after) {
+        uint64_t current_tail = channel->tails[consumer_id].load(std::memory_order_acquire);
+        uint64_t available = channel->head.load(std::memory_order_acquire) - current_tail;
+        if (max_n > available) max_n = static_cast<size_t>(available);
 
-            release(); 
-            return nullptr; 
+        size_t n = 0;
+        for (; n < max_n; n++) {
+            const auto &slot = channel->slots[(current_tail + n) % BufferSize];
+            if (slot.sequence.load(std::memory_order_acquire) != current_tail + n + 1 ||
+                slot.state.load(std::memory_order_acquire) != SlotState::READY) break;
+            if (slot.commit_ns != 0 && sampled_tail != current_tail + n) {
+                detail::record_latency(channel->metrics.latency, slot.commit_ns);
+                sampled_tail = current_tail + n;
+            }
         }
 
-        return &slot->data;
+        // Nothing ready at the tail itself: let peek() handle laps and
+        // in-flight commits.
+        if (n == 0 && max_n > 0 && peek()) {
+            return SlotBatch<T>(channel->slots, BufferSize, read_tail, 1);
+        }
+
+        read_tail = current_tail;
+        peeked = n;
+        return SlotBatch<T>(channel->slots, BufferSize, current_tail, n);
     }
 
-    void release() {
-       channel->heartbeats[consumer_id].store(now_ms(), std::memory_order_relaxed);
-        
-        size_t current_tail = channel->tails[consumer_id].load(std::memory_order_relaxed);
-        channel->tails[consumer_id].store((current_tail + 1) % BufferSize, std::memory_order_release);
+    // peek_valid() for entry i of the last peek_batch(). Safe to call from
+    // several threads at once, e.g. workers each handling one entry; it
+    // does not count torn_reads.
+    bool batch_valid(size_t i) const {
+        const auto &slot = channel->slots[(read_tail + i) % BufferSize];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.state.load(std::memory_order_relaxed) == SlotState::READY &&
+               slot.sequence.load(std::memory_order_relaxed) == read_tail + i + 1;
     }
 
-    const T *wait_and_peek() {
-        int spin_count = 0;
-        const T *ptr = nullptr;
-        while ((ptr = peek()) == nullptr) {
-            if (spin_count < settings.spin_iterations) { _mm_pause(); spin_count++; }
-            else if (spin_count < settings.yield_iterations) { std::this_thread::yield(); spin_count++; }
-            else { std::this_thread::sleep_for(std::chrono::microseconds(1)); }
+    // Claim numbers of the slot from prepare_publish() and of the last
+    // peek()/peek_batch() (entry 0). The slot index is the claim number
+    // % BufferSize, so side arenas can be indexed in step with the ring
+    // (see SplitBroker).
+    uint64_t pending_claim() const { return pending_seq; }
+    uint64_t read_position() const { return read_tail; }
+
+    void release() { release_n(1); }
+
+    // Advances the tail past n slots from the last peek()/peek_batch() with
+    // a single heartbeat and tail update. n is capped at what that peek
+    // returned and not yet released; without one this is a no-op.
+    void release_n(size_t n) {
+        require_consumer_id();
+        detail::touch_heartbeat(channel->heartbeats[consumer_id], last_heartbeat);
+        if (n > peeked) n = peeked;
+        if (n == 0) return;
+
+        // CAS so we never move the tail back behind an overwriting producer.
+        // Slots it already pushed us past were counted as overwritten.
+        uint64_t target = read_tail + n;
+        uint64_t current_tail = channel->tails[consumer_id].load(std::memory_order_relaxed);
+        while (current_tail < target &&
+               !channel->tails[consumer_id].compare_exchange_weak(current_tail, target,
+                                                                  std::memory_order_release,
+                                                                  std::memory_order_relaxed)) {
+        }
+        if (current_tail < target) {
+            detail::count_local(channel->metrics.consumers[consumer_id].consumed,
+                                target - std::max(current_tail, read_tail));
         }
-        return ptr;
+        peeked -= n;
+        read_tail = target;
+    }
+
+    // Waits according to settings.wait_strategy. Returns nullptr only if
+    // timeout_ms (>= 0) elapses without a frame. With settings.conflate the
+    // frame returned is the newest one (peek_latest()).
+    const T *wait_and_peek(int64_t timeout_ms = -1) {
+        return detail::wait_for_data(settings, channel->signal, timeout_ms,
+                                     [this] { return settings.conflate ? peek_latest() : peek(); });
+    }
+
+    const T *wait_and_peek_latest(int64_t timeout_ms = -1) {
+        return detail::wait_for_data(settings, channel->signal, timeout_ms, [this] { return peek_latest(); });
+    }
+
+    // Readiness probe for external event loops. Touches neither heartbeat
+    // nor tail, so it is safe to call from a helper thread while another
+    // thread consumes. Head counts claims, so the slot at the tail decides:
+    // it must be committed (READY, or ABORTED for peek() to step over), or
+    // lapped. A claim still being written or a QUEUED ticket is not data.
+    bool has_data() const {
+        if (consumer_id < 0) return false;
+        uint64_t t = channel->tails[consumer_id].load(std::memory_order_acquire);
+        if (t == channel->head.load(std::memory_order_acquire)) return false;
+
+        const auto &slot = channel->slots[t % BufferSize];
+        uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (seq > t + 1) return true;
+        SlotState state = slot.state.load(std::memory_order_acquire);
+        return seq == t + 1 && (state == SlotState::READY || state == SlotState::ABORTED);
     }
 
+    // Publish counter for use with wait_for_publish(): read it, check
+    // has_data(), then wait on the value read.
+    uint32_t publish_count() const { return channel->signal.sequence.load(std::memory_order_seq_cst); }
+
+    void wait_for_publish(uint32_t seen, int64_t timeout_ms = -1) {
+        detail::wait_for_publish(channel->signal, seen, timeout_ms < 0 ? -1 : timeout_ms * 1000);
+    }
+
+    // Wakes every thread blocked on this channel (e.g. to shut one down).
+    void wake_waiters() { detail::futex_wake_all(&channel->signal.sequence); }
+
+    // Publish notification word, for waiting on several channels at once
+    // (see BrokerGroup).
+    ChannelSignal &signal() { return channel->signal; }
+
 
     
     void print_stats() {
-        size_t h = channel->head.load(std::memory_order_relaxed);
+        uint64_t h = channel->head.load(std::memory_order_relaxed);
         int64_t now = now_ms();
         std::cout << "--- NanoBroker Stats [" << name << "] ---" << std::endl;
-        std::cout << "Magic: " << std::hex << channel->magic << std::dec << std::endl;
+        std::cout << "Magic: " << std::hex << channel->header.magic << std::dec << std::endl;
         std::cout << "Head: " << h << std::endl;
         
         for (size_t i=0; i<MaxConsumers; i++) {
-            if (channel->slot_active[i].load(std::memory_order_relaxed)) {
-                size_t t = channel->tails[i].load(std::memory_order_relaxed);
+            if (detail::is_active(channel->active_mask, i)) {
+                uint64_t t = channel->tails[i].load(std::memory_order_relaxed);
                 int64_t hb = channel->heartbeats[i].load(std::memory_order_relaxed);
                 int64_t age = now - hb;
-                std::cout << "  [ID " << i << "] Tail: " << t << " | Age: " << age << "ms" << std::endl;
+                std::cout << "  [ID " << i << "] Tail: " << t << " | Lag: " << (h - t)
+                          << " | Age: " << age << "ms" << std::endl;
             }
         }
         std::cout << "-----------------------------------" << std::endl;
     }
     
+    const ChannelMetrics<MaxConsumers> &metrics() const { return channel->metrics; }
+
+    void print_metrics() {
+        uint64_t h = channel->head.load(std::memory_order_relaxed);
+        std::cout << "--- NanoBroker Metrics [" << name << "] ---" << std::endl;
+        std::cout << "Head: " << h << std::endl;
+        detail::print_metrics(channel->metrics, channel->active_mask, h, channel->tails);
+        std::cout << "-----------------------------------" << std::endl;
+    }
+
     void force_disconnect_consumer(int id) {
         if (id < 0 || id >= (int)MaxConsumers) return;
-        channel->slot_active[id].store(false, std::memory_order_release);
+        channel->active_mask.fetch_and(~detail::consumer_bit(id), std::memory_order_release);
     }
 
     static void unlink_memory(const std::string &name) {
-        std::string path = "/" + name;
-        shm_unlink(path.c_str());
+        SharedSegment::unlink("/" + name);
     }
 };
 
@@ -0,0 +1,128 @@
+#ifndef NANOBROKER_REALTIME_HPP
+#define NANOBROKER_REALTIME_HPP
+
+#include "NanoBroker.hpp"
+#include <functional>
+#include <sstream>
+#include <vector>
+
+namespace NanoBroker {
+
+// Parses a kernel CPU list such as "0-3,8,10-11".
+inline std::vector<int> parse_cpu_list(const std::string &list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+namespace detail {
+
+inline std::vector<int> read_cpu_list(const std::string &path) {
+    std::ifstream file(path);
+    std::string list;
+    std::getline(file, list);
+    return parse_cpu_list(list);
+}
+
+} // namespace detail
+
+// CPUs reserved with isolcpus= (empty if none). Spin-only consumers belong
+// here so the scheduler never puts anything else on their core.
+inline std::vector<int> isolated_cpus() {
+    return detail::read_cpu_list("/sys/devices/system/cpu/isolated");
+}
+
+// CPUs sharing `cpu`'s last-level cache. Keeping a producer and its
+// latency-critical consumers inside one such set keeps head/tail and slot
+// cache lines moving through L3 rather than across sockets or CCXs.
+inline std::vector<int> llc_siblings(int cpu) {
+    std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/";
+    for (int index = 3; index >= 0; index--) {
+        std::vector<int> cpus = detail::read_cpu_list(base + "index" + std::to_string(index) + "/shared_cpu_list");
+        if (!cpus.empty()) return cpus;
+    }
+    return {cpu};
+}
+
+inline bool pin_current_thread(int cpu) { return detail::pin_thread(cpu); }
+inline bool set_realtime_priority(int priority) { return detail::set_realtime_priority(priority); }
+
+// Dedicated busy-poll consumer thread. The thread pins itself to `cpu` and
+// optionally raises itself to SCHED_FIFO, then spins on peek() and hands
+// each message to the callback, never sleeping in the kernel. Works with
+// any broker whose peek() returns a pointer (Broker, SpscBroker); the
+// broker must be a consumer and must not be used by other threads while
+// the poller runs.
+//
+// A SCHED_FIFO spinner never yields: give it an isolated core, or it starves
+// everything else on that CPU until RT throttling kicks in.
+template <typename B>
+class PollingConsumer {
+public:
+    using Message = typename std::remove_pointer<decltype(std::declval<B &>().peek())>::type;
+    using Callback = std::function<void(Message &)>;
+
+private:
+    B &broker;
+    Callback callback;
+    int cpu;
+    int priority;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> delivered{0};
+    std::thread worker;
+
+    void run() {
+        if (cpu >= 0) detail::pin_thread(cpu);
+        if (priority > 0) detail::set_realtime_priority(priority);
+
+        uint64_t count = 0;
+        try {
+            while (running.load(std::memory_order_relaxed)) {
+                Message *message = broker.peek();
+                if (!message) { _mm_pause(); continue; }
+                callback(*message);
+                broker.release();
+                delivered.store(++count, std::memory_order_relaxed);
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "[NanoBroker] Polling consumer stopped: " << e.what() << std::endl;
+            running.store(false, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    PollingConsumer(B &consumer, Callback on_message, int cpu_id = -1, int rt_priority = 0)
+        : broker(consumer), callback(std::move(on_message)), cpu(cpu_id), priority(rt_priority) {}
+
+    ~PollingConsumer() { stop(); }
+
+    PollingConsumer(const PollingConsumer &) = delete;
+    PollingConsumer &operator=(const PollingConsumer &) = delete;
+
+    void start() {
+        if (worker.joinable()) return;
+        running.store(true, std::memory_order_relaxed);
+        worker = std::thread(&PollingConsumer::run, this);
+    }
+
+    // Returns after the current callback, if any, has finished.
+    void stop() {
+        running.store(false, std::memory_order_relaxed);
+        if (worker.joinable()) worker.join();
+    }
+
+    // False once stopped, including after the broker threw (e.g. kicked).
+    bool is_running() const { return running.load(std::memory_order_relaxed); }
+    uint64_t messages() const { return delivered.load(std::memory_order_relaxed); }
+};
+
+} // namespace NanoBroker
+#endif
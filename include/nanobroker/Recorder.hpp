@@ -0,0 +1,382 @@
+#ifndef NANOBROKER_RECORDER_HPP
+#define NANOBROKER_RECORDER_HPP
+
+#include "NanoBroker.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace NanoBroker {
+
+const uint64_t RECORDING_MAGIC = 0x4E414E4F5245434FULL; // "NANORECO" in hex
+const uint32_t RECORDING_VERSION = 1;
+
+// Recording file layout: one page of RecordingHeader, then entries packed
+// back to back, each a LogEntry followed by its payload and padded to 64
+// bytes. The entries are self-describing; "<path>.idx" holds an IndexEntry
+// per entry so a replayer can seek without walking the log.
+struct RecordingHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t struct_size;
+    uint64_t entries;    // Committed entries (the log may end in a torn one)
+    uint64_t data_end;   // File offset one past the last committed entry
+    int64_t started_ns;
+    NanoString<64> topic;
+};
+
+struct alignas(64) LogEntry {
+    uint64_t bytes;        // Payload bytes that follow
+    uint64_t sequence;     // Position in the recording, from 0
+    int64_t timestamp_ns;  // When the recorder received it (CLOCK_MONOTONIC)
+};
+
+struct IndexEntry {
+    uint64_t offset;
+    int64_t timestamp_ns;
+};
+
+namespace detail {
+
+const uint64_t RECORDING_DATA_OFFSET = 4096;
+
+// Data is written through a sliding mmap window. A full window is handed
+// to writeback as one sequential range and unmapped; the window before it
+// is then waited on and dropped from the page cache, so at most two windows
+// are dirty or cached. The recorder blocks only when the disk is slower
+// than the topic.
+const uint64_t RECORDING_WINDOW = 64 * 1024 * 1024;
+
+inline uint64_t entry_stride(uint64_t bytes) { return (sizeof(LogEntry) + bytes + 63) & ~uint64_t(63); }
+
+} // namespace detail
+
+// Records a topic to an append-only log. Attaches as an ordinary consumer;
+// the payload (payload_size() bytes, so only the filled part of a frame)
+// is copied into the mapped file with non-temporal stores and validated
+// against an overwriting producer before it counts. The frame's own fields
+// (frame_id, timestamp_ns, ...) travel inside the payload.
+template <typename T, size_t BufferSize = 30, size_t MaxConsumers = 16>
+class Recorder {
+    std::string path;
+    Broker<T, BufferSize, MaxConsumers> source;
+    int fd = -1;
+    RecordingHeader *header = nullptr;
+
+    uint8_t *window = nullptr;
+    uint64_t window_start = 0; // File offset of window[0]
+    uint64_t window_size = 0;
+    uint64_t file_size = 0;
+    uint64_t written_start = 0; // Range handed to writeback by the last retire
+    uint64_t written_end = 0;
+    std::vector<IndexEntry> pending_index;
+    int index_fd = -1;
+
+    // Waits for the previously retired window to reach the disk, drops it
+    // from the page cache, then starts writeback of this window's entries
+    // and unmaps it.
+    void retire_window() {
+        if (!window) return;
+        if (written_end > written_start) {
+            sync_file_range(fd, written_start, written_end - written_start,
+                            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+            posix_fadvise(fd, written_start, written_end - written_start, POSIX_FADV_DONTNEED);
+        }
+        munmap(window, window_size);
+        window = nullptr;
+        written_start = window_start;
+        written_end = header->data_end;
+        sync_file_range(fd, written_start, written_end - written_start, SYNC_FILE_RANGE_WRITE);
+        flush_index();
+    }
+
+    // Allocates blocks up to `size` so that a full disk or quota surfaces
+    // here as an error rather than as SIGBUS on a store into the mapping.
+    void grow(uint64_t size) {
+        if (size <= file_size) return;
+        int err = posix_fallocate(fd, file_size, size - file_size);
+        if (err != 0) throw std::runtime_error("Cannot grow " + path + ": " + std::strerror(err));
+        file_size = size;
+    }
+
+    // Makes [offset, offset + bytes) writable through `window`.
+    uint8_t *reserve(uint64_t offset, uint64_t bytes) {
+        if (window && offset + bytes <= window_start + window_size) return window + (offset - window_start);
+
+        retire_window();
+        window_start = offset & ~uint64_t(4095);
+        window_size = std::max(detail::RECORDING_WINDOW, offset + bytes - window_start);
+        grow(window_start + window_size);
+
+        void *addr = mmap(nullptr, window_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, window_start);
+        if (addr == MAP_FAILED) throw std::runtime_error("mmap failed on " + path);
+        window = static_cast<uint8_t *>(addr);
+        return window + (offset - window_start);
+    }
+
+    void flush_index() {
+        if (pending_index.empty()) return;
+        size_t bytes = pending_index.size() * sizeof(IndexEntry);
+        if (write(index_fd, pending_index.data(), bytes) != static_cast<ssize_t>(bytes)) {
+            std::cerr << "[NanoBroker] Short write on " << path << ".idx" << std::endl;
+        }
+        pending_index.clear();
+    }
+
+public:
+    Recorder(const std::string &topic, const std::string &file_path, int id = AUTO_ID,
+             BrokerSettings custom_settings = BrokerSettings())
+        : path(file_path), source(topic, false, id, custom_settings)
+    {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1) throw std::runtime_error("Cannot create recording " + path);
+        index_fd = ::open((path + ".idx").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (index_fd == -1) { ::close(fd); throw std::runtime_error("Cannot create index " + path + ".idx"); }
+
+        grow(detail::RECORDING_DATA_OFFSET);
+        void *addr = mmap(nullptr, detail::RECORDING_DATA_OFFSET, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) throw std::runtime_error("mmap failed on " + path);
+        header = static_cast<RecordingHeader *>(addr);
+
+        header->magic = RECORDING_MAGIC;
+        header->version = RECORDING_VERSION;
+        header->struct_size = sizeof(T);
+        header->entries = 0;
+        header->data_end = detail::RECORDING_DATA_OFFSET;
+        header->started_ns = detail::now_ns();
+        header->topic = topic;
+    }
+
+    ~Recorder() {
+        if (!header) return;
+        retire_window();
+        if (ftruncate(fd, header->data_end) == -1) {
+            std::cerr << "[NanoBroker] Cannot trim " << path << std::endl;
+        }
+        munmap(header, detail::RECORDING_DATA_OFFSET);
+        ::close(index_fd);
+        ::close(fd);
+    }
+
+    Recorder(const Recorder &) = delete;
+    Recorder &operator=(const Recorder &) = delete;
+
+    // Appends every frame waiting on the topic. Returns frames recorded.
+    size_t pump() {
+        size_t recorded = 0;
+        while (const T *frame = source.peek()) {
+            uint64_t bytes = payload_size(*frame);
+            uint64_t offset = header->data_end;
+            uint8_t *dst = reserve(offset, detail::entry_stride(bytes));
+
+            detail::stream_copy(dst + sizeof(LogEntry), frame, bytes);
+            if (!source.peek_valid()) continue; // Overwritten mid-copy; peek() skips ahead
+
+            LogEntry *entry = reinterpret_cast<LogEntry *>(dst);
+            entry->bytes = bytes;
+            entry->sequence = header->entries;
+            entry->timestamp_ns = detail::now_ns();
+            source.release();
+
+            pending_index.push_back({offset, entry->timestamp_ns});
+            header->data_end = offset + detail::entry_stride(bytes);
+            header->entries++;
+            recorded++;
+        }
+        return recorded;
+    }
+
+    // Waits on the topic according to settings.wait_strategy, then pumps.
+    size_t wait_and_pump(int64_t timeout_ms = -1) {
+        if (!source.wait_and_peek(timeout_ms)) return 0;
+        return pump();
+    }
+
+    uint64_t entries() const { return header->entries; }
+    uint64_t bytes_written() const { return header->data_end - detail::RECORDING_DATA_OFFSET; }
+    int id() const { return source.id(); }
+};
+
+// Read-only view of a recording: the header, an index and each entry's
+// payload, mapped straight from the file.
+class Recording {
+    std::string path;
+    size_t mapped_size = 0;
+    const uint8_t *base = nullptr;
+    std::vector<IndexEntry> index;
+
+    const LogEntry &entry(size_t i) const { return *reinterpret_cast<const LogEntry *>(base + index[i].offset); }
+
+    // True if an entry at `offset` lies wholly inside the committed data
+    // and its payload fits the recorded struct.
+    bool entry_ok(uint64_t offset) const {
+        uint64_t end = header().data_end;
+        if (offset < detail::RECORDING_DATA_OFFSET || offset % 64 != 0 || offset + sizeof(LogEntry) > end) return false;
+        uint64_t bytes = reinterpret_cast<const LogEntry *>(base + offset)->bytes;
+        return bytes <= header().struct_size && offset + detail::entry_stride(bytes) <= end;
+    }
+
+    // Loads "<path>.idx", or rebuilds it by walking the entries when it is
+    // missing or does not match the header (e.g. the recorder was killed).
+    // A corrupt log is cut short at its first bad entry.
+    void load_index() {
+        uint64_t count = header().entries;
+        uint64_t most = (header().data_end - detail::RECORDING_DATA_OFFSET) / sizeof(LogEntry);
+        if (count > most) count = most;
+
+        index.resize(count);
+        int fd = ::open((path + ".idx").c_str(), O_RDONLY);
+        if (fd != -1) {
+            ssize_t want = count * sizeof(IndexEntry);
+            bool ok = read(fd, index.data(), want) == want;
+            ::close(fd);
+            for (uint64_t i = 0; ok && i < count; i++) ok = entry_ok(index[i].offset);
+            if (ok) return;
+        }
+
+        uint64_t offset = detail::RECORDING_DATA_OFFSET;
+        for (uint64_t i = 0; i < count; i++) {
+            if (!entry_ok(offset)) {
+                std::cerr << "[NanoBroker] " << path << " is corrupt after entry " << i << std::endl;
+                index.resize(i);
+                return;
+            }
+            const LogEntry *e = reinterpret_cast<const LogEntry *>(base + offset);
+            index[i] = {offset, e->timestamp_ns};
+            offset += detail::entry_stride(e->bytes);
+        }
+    }
+
+public:
+    explicit Recording(const std::string &file_path) : path(file_path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) throw std::runtime_error("Cannot open recording " + path);
+        struct stat st;
+        fstat(fd, &st);
+        mapped_size = st.st_size;
+        void *addr = mapped_size >= detail::RECORDING_DATA_OFFSET
+                         ? mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (addr == MAP_FAILED) throw std::runtime_error("Cannot map recording " + path);
+        base = static_cast<const uint8_t *>(addr);
+        madvise(addr, mapped_size, MADV_SEQUENTIAL);
+
+        if (header().magic != RECORDING_MAGIC || header().data_end > mapped_size ||
+            header().data_end < detail::RECORDING_DATA_OFFSET) {
+            munmap(addr, mapped_size);
+            throw std::runtime_error("Not a NanoBroker recording (or truncated): " + path);
+        }
+        if (header().version != RECORDING_VERSION) {
+            munmap(addr, mapped_size);
+            throw std::runtime_error("Recording Version Mismatch!");
+        }
+        load_index();
+    }
+
+    ~Recording() { munmap(const_cast<uint8_t *>(base), mapped_size); }
+
+    Recording(const Recording &) = delete;
+    Recording &operator=(const Recording &) = delete;
+
+    const RecordingHeader &header() const { return *reinterpret_cast<const RecordingHeader *>(base); }
+    size_t size() const { return index.size(); }
+
+    const void *payload(size_t i) const { return &entry(i) + 1; }
+    uint64_t bytes(size_t i) const { return entry(i).bytes; }
+
+    // Recorder-side receive time of entry i, relative to the first entry.
+    int64_t offset_ns(size_t i) const { return index[i].timestamp_ns - index[0].timestamp_ns; }
+
+    // First entry at or after `ns` into the recording.
+    size_t find(int64_t ns) const {
+        if (index.empty()) return 0;
+        int64_t t = index[0].timestamp_ns + ns;
+        return std::lower_bound(index.begin(), index.end(), t,
+                                [](const IndexEntry &e, int64_t v) { return e.timestamp_ns < v; }) - index.begin();
+    }
+};
+
+// Republishes a recording into a topic through prepare_publish() /
+// commit_publish(), at the recorded pace or flat out.
+template <typename T, size_t BufferSize = 30, size_t MaxConsumers = 16>
+class Replayer {
+    Recording log;
+    Broker<T, BufferSize, MaxConsumers> sink;
+    BrokerSettings settings;
+    size_t position = 0;
+
+    // prepare_publish() does not wait for a slot (its argument is only the
+    // auto-kick threshold), so retry while a consumer holds the ring full
+    // under BLOCK: spin, then yield, then sleep, as wait strategies do.
+    // Gives up at deadline_ns (-1 = never) or once `running` is cleared.
+    T *claim_slot(int64_t deadline_ns, const std::atomic<bool> *running) {
+        for (int64_t attempt = 0;; attempt++) {
+            if (T *slot = sink.prepare_publish(settings.producer_timeout_ms)) return slot;
+            if (deadline_ns >= 0 && detail::now_ns() >= deadline_ns) return nullptr;
+            if (running && !running->load(std::memory_order_relaxed)) return nullptr;
+
+            if (attempt < settings.spin_iterations) _mm_pause();
+            else if (attempt < settings.yield_iterations) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    bool publish_next(int64_t timeout_ms, const std::atomic<bool> *running) {
+        if (position >= log.size()) return false;
+        int64_t deadline = timeout_ms < 0 ? -1 : detail::now_ns() + timeout_ms * 1000000;
+        T *slot = claim_slot(deadline, running);
+        if (!slot) return false;
+
+        detail::stream_copy(slot, log.payload(position), log.bytes(position));
+        sink.commit_publish();
+        position++;
+        return true;
+    }
+
+public:
+    Replayer(const std::string &file_path, const std::string &topic,
+             BrokerSettings custom_settings = BrokerSettings())
+        : log(file_path), sink(topic, true, 0, custom_settings), settings(custom_settings)
+    {
+        if (log.header().struct_size != sizeof(T)) throw std::runtime_error("Data Struct Size Mismatch!");
+    }
+
+    const Recording &recording() const { return log; }
+    size_t size() const { return log.size(); }
+    size_t tell() const { return position; }
+    bool at_end() const { return position >= log.size(); }
+
+    // Positions the replay at the first entry at or after `ns` into the log.
+    void seek(int64_t ns) { position = log.find(ns); }
+
+    // Publishes the next entry, waiting up to timeout_ms (-1 = no limit) for
+    // a free slot. Returns false at the end of the log (see at_end()) or
+    // when no slot freed up in time.
+    bool step(int64_t timeout_ms = -1) { return publish_next(timeout_ms, nullptr); }
+
+    // Publishes from the current position to the end. speed 1.0 keeps the
+    // recorded spacing, 2.0 plays twice as fast, 0 publishes flat out.
+    // `running` may be cleared from another thread to stop early; each entry
+    // waits up to timeout_ms (-1 = no limit) for a free slot. Returns entries
+    // published; at_end() tells a finished replay from a stopped or blocked
+    // one.
+    size_t play(double speed = 1.0, const std::atomic<bool> *running = nullptr, int64_t timeout_ms = -1) {
+        size_t published = 0;
+        int64_t start = detail::now_ns();
+        int64_t first = position < log.size() ? log.offset_ns(position) : 0;
+        while (position < log.size() && (!running || running->load(std::memory_order_relaxed))) {
+            if (speed > 0) {
+                int64_t due = start + static_cast<int64_t>((log.offset_ns(position) - first) / speed);
+                int64_t ahead = due - detail::now_ns();
+                if (ahead > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(ahead));
+            }
+            if (!publish_next(timeout_ms, running)) break;
+            published++;
+        }
+        return published;
+    }
+
+    Broker<T, BufferSize, MaxConsumers> &broker() { return sink; }
+};
+
+} // namespace NanoBroker
+#endif
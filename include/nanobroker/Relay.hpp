@@ -0,0 +1,63 @@
+#ifndef NANOBROKER_RELAY_HPP
+#define NANOBROKER_RELAY_HPP
+
+#include "NanoBroker.hpp"
+
+namespace NanoBroker {
+
+// Fan-out stage for large subscriber counts. A relay attaches to a parent
+// topic as one ordinary consumer and re-publishes each frame into a child
+// topic of its own, which up to MaxConsumers further subscribers read. The
+// parent producer only ever scans its direct consumers, so two levels of
+// 16-wide rings serve 256 subscribers, at the cost of one copy per level
+// (of payload_size() bytes, not the whole slot).
+template <typename T, size_t BufferSize = 30, size_t MaxConsumers = 16>
+class Relay {
+    BrokerSettings settings;
+    Broker<T, BufferSize, MaxConsumers> upstream;
+    Broker<T, BufferSize, MaxConsumers> downstream;
+
+public:
+    Relay(const std::string &parent_topic, const std::string &child_topic, int id = AUTO_ID,
+          BrokerSettings custom_settings = BrokerSettings())
+        : settings(custom_settings),
+          upstream(parent_topic, false, id, custom_settings),
+          downstream(child_topic, true, 0, custom_settings) {}
+
+    // Forwards every frame waiting upstream. Each copy is validated against
+    // the parent slot before it is committed downstream, so an overwriting
+    // parent never leaks a torn frame into the child. Stops early, leaving
+    // the rest upstream, when the child ring is full. Returns frames forwarded.
+    size_t pump() {
+        size_t forwarded = 0;
+        while (const T *frame = upstream.peek()) {
+            T *slot = downstream.prepare_publish(settings.producer_timeout_ms);
+            if (!slot) break;
+
+            detail::stream_copy(slot, frame, payload_size(*frame));
+            if (upstream.peek_valid()) {
+                downstream.commit_publish();
+                upstream.release();
+                forwarded++;
+            } else {
+                downstream.abort_publish();
+            }
+        }
+        return forwarded;
+    }
+
+    // Waits on the parent according to settings.wait_strategy, then pumps.
+    size_t wait_and_pump(int64_t timeout_ms = -1) {
+        if (!upstream.wait_and_peek(timeout_ms)) return 0;
+        return pump();
+    }
+
+    // ID this relay holds on the parent topic.
+    int id() const { return upstream.id(); }
+
+    Broker<T, BufferSize, MaxConsumers> &parent() { return upstream; }
+    Broker<T, BufferSize, MaxConsumers> &child() { return downstream; }
+};
+
+} // namespace NanoBroker
+#endif
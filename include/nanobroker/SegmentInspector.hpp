@@ -0,0 +1,142 @@
+#ifndef NANOBROKER_SEGMENT_INSPECTOR_HPP
+#define NANOBROKER_SEGMENT_INSPECTOR_HPP
+
+#include "NanoBroker.hpp"
+#include <dirent.h>
+#include <vector>
+
+namespace NanoBroker {
+
+// Type-agnostic view of any channel's control data. Layout comes from the
+// SegmentHeader, and only the pages in front of the slot array / arena are
+// mapped, so watching many large topics stays cheap.
+class SegmentInspector {
+    std::string name;
+    SharedSegment segment;
+    uint8_t *base = nullptr;
+
+    template <typename F> F *at(uint64_t offset) const { return reinterpret_cast<F *>(base + offset); }
+
+    static bool has_magic(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) return false;
+        uint64_t magic = 0;
+        bool ok = pread(fd, &magic, sizeof(magic), 0) == sizeof(magic) && magic == MAGIC_NUMBER;
+        ::close(fd);
+        return ok;
+    }
+
+    static void scan(const std::string &dir, std::vector<std::string> &topics) {
+        DIR *d = opendir(dir.c_str());
+        if (!d) return;
+        while (struct dirent *entry = readdir(d)) {
+            if (entry->d_name[0] == '.') continue;
+            if (has_magic(dir + "/" + entry->d_name)) topics.push_back(entry->d_name);
+        }
+        closedir(d);
+    }
+
+public:
+    // Consumer entries past max_consumers are not mapped; index them only
+    // for IDs below layout().max_consumers.
+    using Metrics = ChannelMetrics<64>;
+
+    explicit SegmentInspector(const std::string &topic) : name("/" + topic) {
+        segment.open(name, sizeof(SegmentHeader), false, BrokerSettings());
+        const SegmentHeader *header = static_cast<const SegmentHeader *>(segment.data());
+        if (header->magic != MAGIC_NUMBER) throw std::runtime_error("SHM Magic Mismatch! (Old/Corrupt Memory)");
+        if (header->version != PROTOCOL_VERSION) throw std::runtime_error("Protocol Version Mismatch!");
+
+        uint64_t control_size = header->data_offset;
+        segment.close();
+        segment.open(name, control_size, false, BrokerSettings());
+        base = static_cast<uint8_t *>(segment.data());
+    }
+
+    // Topics (segment names without the leading '/') of every NanoBroker
+    // segment in /dev/shm and on a mounted hugetlbfs.
+    static std::vector<std::string> list() {
+        std::vector<std::string> topics;
+        scan("/dev/shm", topics);
+        std::string huge = detail::hugetlbfs_mount();
+        if (!huge.empty()) scan(huge, topics);
+        return topics;
+    }
+
+    const std::string &topic() const { return name; }
+    const SegmentHeader &layout() const { return *at<const SegmentHeader>(0); }
+
+    const char *kind_name() const {
+        switch (layout().kind) {
+            case ChannelKind::FIXED: return "fixed";
+            case ChannelKind::BYTES: return "bytes";
+            case ChannelKind::SPSC: return "spsc";
+        }
+        return "?";
+    }
+
+    uint64_t head() const {
+        return at<std::atomic<uint64_t>>(layout().head_offset)->load(std::memory_order_relaxed);
+    }
+    uint64_t tail(size_t id) const {
+        return at<std::atomic<uint64_t>>(layout().tails_offset)[id].load(std::memory_order_relaxed);
+    }
+    bool is_active(size_t id) const {
+        return id < layout().max_consumers &&
+               detail::is_active(*at<std::atomic<uint64_t>>(layout().active_mask_offset), id);
+    }
+    int64_t heartbeat(size_t id) const {
+        return at<std::atomic<int64_t>>(layout().heartbeats_offset)[id].load(std::memory_order_relaxed);
+    }
+    const Metrics &metrics() const { return *at<const Metrics>(layout().metrics_offset); }
+
+    // Largest head - tail over active consumers (slots, or bytes for BYTES).
+    uint64_t max_lag() const {
+        uint64_t h = head(), lag = 0;
+        for (size_t i = 0; i < layout().max_consumers; i++) {
+            if (is_active(i) && h - tail(i) > lag) lag = h - tail(i);
+        }
+        return lag;
+    }
+
+    void print_stats() const {
+        const SegmentHeader &info = layout();
+        uint64_t h = head();
+        int64_t now = detail::coarse_now_ms();
+        const char *unit = info.kind == ChannelKind::BYTES ? " bytes" : "";
+
+        std::cout << "--- NanoBroker Stats [" << name << "] ---" << std::endl;
+        if (info.kind == ChannelKind::BYTES) {
+            std::cout << "Kind: bytes | Arena: " << info.buffer_capacity << " bytes";
+        } else {
+            std::cout << "Kind: " << kind_name() << " | Capacity: " << info.buffer_capacity << " slots of " << info.struct_size << " bytes";
+        }
+        std::cout << " | Max consumers: " << info.max_consumers << std::endl;
+        std::cout << "Head: " << h << unit << std::endl;
+        for (size_t i = 0; i < info.max_consumers; i++) {
+            if (!is_active(i)) continue;
+            std::cout << "  [ID " << i << "] Tail: " << tail(i) << " | Lag: " << (h - tail(i)) << unit
+                      << " | Age: " << (now - heartbeat(i)) << "ms" << std::endl;
+        }
+        std::cout << "-----------------------------------" << std::endl;
+    }
+
+    void print_metrics() const {
+        const SegmentHeader &info = layout();
+        uint64_t h = head();
+        std::cout << "--- NanoBroker Metrics [" << name << "] ---" << std::endl;
+        std::cout << "Head: " << h << (info.kind == ChannelKind::BYTES ? " bytes" : "") << std::endl;
+        detail::print_metrics(metrics(), *at<std::atomic<uint64_t>>(info.active_mask_offset), h,
+                              at<std::atomic<uint64_t>>(info.tails_offset));
+        std::cout << "-----------------------------------" << std::endl;
+    }
+
+    void force_disconnect_consumer(int id) {
+        if (id < 0 || id >= static_cast<int>(layout().max_consumers)) return;
+        at<std::atomic<uint64_t>>(layout().active_mask_offset)
+            ->fetch_and(~detail::consumer_bit(id), std::memory_order_release);
+    }
+};
+
+} // namespace NanoBroker
+#endif
@@ -0,0 +1,136 @@
+#ifndef NANOBROKER_SPLIT_BROKER_HPP
+#define NANOBROKER_SPLIT_BROKER_HPP
+
+#include "NanoBroker.hpp"
+
+namespace NanoBroker {
+
+// Payload side of a SplitBroker: BufferSize payloads indexed like the
+// header ring's slots, in a segment of its own ("<topic>.payload").
+template <typename Payload, size_t BufferSize>
+struct alignas(64) PayloadArena {
+    std::atomic<uint64_t> magic; // MAGIC_NUMBER, stored last by the creator
+    uint64_t payload_size;
+    uint64_t capacity;
+    alignas(4096) Payload payloads[BufferSize];
+};
+
+// Structure-of-arrays topic: a Broker<Header> ring of small headers plus a
+// separate payload arena, with payload i belonging to header slot i. The
+// header ring is compact and contiguous, so a consumer can scan and filter
+// headers (frame id, timestamp, producer) without touching a payload cache
+// line, then prefetch and read only the payloads it keeps.
+//
+// Payload slot i is reused only when header slot i is, so the header
+// ring's ordering, overflow policy and peek_valid() cover the payload too.
+// Write the payload before committing the header.
+template <typename Header, typename Payload, size_t BufferSize = 30, size_t MaxConsumers = 16>
+class SplitBroker {
+    static_assert(std::is_trivially_copyable<Payload>::value, "NanoBroker Error: Payload type must be POD.");
+
+    using Arena = PayloadArena<Payload, BufferSize>;
+
+    // The arena is declared (and, by the creator, set up) before the header
+    // ring, so a consumer that can attach to the ring finds it complete.
+    SharedSegment payload_segment;
+    Arena *arena = nullptr;
+    Broker<Header, BufferSize, MaxConsumers> headers;
+
+    Payload *payload_for(uint64_t claim) const { return &arena->payloads[claim % BufferSize]; }
+
+    static Arena *create_arena(SharedSegment &segment, const std::string &channel_name,
+                               const BrokerSettings &settings) {
+        // Placement first, as in the Broker constructor: this is the bulk
+        // of the topic's memory.
+        detail::apply_thread_settings(settings);
+        segment.open("/" + channel_name + ".payload", sizeof(Arena), true, settings);
+        Arena *created = static_cast<Arena *>(segment.data());
+        created->payload_size = sizeof(Payload);
+        created->capacity = BufferSize;
+        new (&created->magic) std::atomic<uint64_t>(0);
+        created->magic.store(MAGIC_NUMBER, std::memory_order_release);
+        return created;
+    }
+
+public:
+    SplitBroker(const std::string &channel_name, bool create = false, int id = 0,
+                BrokerSettings settings = BrokerSettings())
+        : arena(create ? create_arena(payload_segment, channel_name, settings) : nullptr),
+          headers(channel_name, create, id, settings)
+    {
+        if (create) return;
+
+        payload_segment.open("/" + channel_name + ".payload", sizeof(Arena), false, settings);
+        arena = static_cast<Arena *>(payload_segment.data());
+        // Only a producer restarting right now can leave it unset here.
+        if (arena->magic.load(std::memory_order_acquire) != MAGIC_NUMBER) {
+            throw std::runtime_error("Payload Arena not initialised (Producer restarting?)");
+        }
+        if (arena->payload_size != sizeof(Payload) || arena->capacity != BufferSize) {
+            throw std::runtime_error("Payload Arena Mismatch!");
+        }
+    }
+
+    SplitBroker(const SplitBroker &) = delete;
+    SplitBroker &operator=(const SplitBroker &) = delete;
+
+    int id() const { return headers.id(); }
+
+    // --- Producer ---
+
+    // Claims the next header slot; pending_payload() is its payload. Fill
+    // both, then commit_publish().
+    Header *prepare_publish(int64_t timeout_ms = 2000) { return headers.prepare_publish(timeout_ms); }
+    Payload *pending_payload() { return payload_for(headers.pending_claim()); }
+    void commit_publish() { headers.commit_publish(); }
+    void abort_publish() { headers.abort_publish(); }
+
+    // --- Consumer ---
+
+    const Header *peek() { return headers.peek(); }
+    const Header *peek_latest() { return headers.peek_latest(); }
+    const Header *wait_and_peek(int64_t timeout_ms = -1) { return headers.wait_and_peek(timeout_ms); }
+
+    // Payload of the header returned by the last peek().
+    const Payload *payload() const { return payload_for(headers.read_position()); }
+
+    // Headers only: a batch scan never touches the payload arena.
+    SlotBatch<Header> peek_batch(size_t max_n) { return headers.peek_batch(max_n); }
+
+    // Payload of entry i of the last peek_batch().
+    const Payload *payload(size_t i) const { return payload_for(headers.read_position() + i); }
+
+    // Starts pulling the first `bytes` of entry i's payload into cache,
+    // e.g. for each batch entry that passed the header filter, before
+    // processing the first one.
+    void prefetch_payload(size_t i, size_t bytes = 4096) const {
+        const char *p = reinterpret_cast<const char *>(payload(i));
+        if (bytes > sizeof(Payload)) bytes = sizeof(Payload);
+        for (size_t off = 0; off < bytes; off += 64) _mm_prefetch(p + off, _MM_HINT_T0);
+    }
+
+    // Seqlock checks; a header that is still valid means its payload was
+    // not reclaimed either.
+    bool peek_valid() { return headers.peek_valid(); }
+    bool batch_valid(size_t i) const { return headers.batch_valid(i); }
+
+    // Consumes headers whether or not their payloads were read, so
+    // filtered-out frames cost one header line each.
+    void release() { headers.release(); }
+    void release_n(size_t n) { headers.release_n(n); }
+
+    bool has_data() const { return headers.has_data(); }
+    ChannelSignal &signal() { return headers.signal(); }
+
+    void print_stats() { headers.print_stats(); }
+    void print_metrics() { headers.print_metrics(); }
+
+    // Removes both segments of a topic.
+    static void unlink_memory(const std::string &name) {
+        SharedSegment::unlink("/" + name);
+        SharedSegment::unlink("/" + name + ".payload");
+    }
+};
+
+} // namespace NanoBroker
+#endif
@@ -0,0 +1,275 @@
+#ifndef NANOBROKER_SPSC_BROKER_HPP
+#define NANOBROKER_SPSC_BROKER_HPP
+
+#include "NanoBroker.hpp"
+
+namespace NanoBroker {
+
+// Single-producer / single-consumer channel. Each index has exactly one
+// writer, so the hot path is plain loads and stores: no CAS, no slot state,
+// no tail scan and no clock reads. Each side keeps a cached copy of the
+// other's index and only re-reads the shared one when the cache says the
+// ring looks full (producer) or empty (consumer).
+template <typename T, size_t BufferSize>
+struct alignas(64) SpscChannel {
+
+    SegmentHeader header;
+
+    alignas(64) std::atomic<uint64_t> head;     // Written by the producer only
+    alignas(64) std::atomic<uint64_t> tails[1]; // Written by the consumer only
+    alignas(64) std::atomic<uint64_t> active_mask;
+    std::atomic<uint32_t> consumer_blocking;    // Consumer may sleep on the futex
+    std::atomic<int32_t> owner_pids[1];         // Process holding consumer 0
+    alignas(64) std::atomic<int64_t> heartbeats[1];
+    alignas(64) ChannelSignal signal;
+    alignas(64) ChannelMetrics<1> metrics;
+
+    alignas(64) T slots[BufferSize];
+};
+
+template <typename T, size_t BufferSize = 30>
+class SpscBroker {
+    using Channel = SpscChannel<T, BufferSize>;
+
+private:
+    std::string name;
+    SharedSegment segment;
+    Channel *channel;
+    bool is_owner;
+    uint64_t local_epoch_cache = 0;
+    BrokerSettings settings;
+
+    // Producer side
+    uint64_t write_index = 0;
+    uint64_t cached_tail = 0;
+    bool pending = false;
+    uint64_t stalled_tail = 0;  // Tail when the producer first found the ring full
+    int64_t stalled_since = 0;
+
+    // Consumer side
+    int32_t self_pid = static_cast<int32_t>(getpid());
+    uint64_t read_index = 0;
+    uint64_t cached_head = 0;
+    int64_t last_heartbeat = 0;
+
+    int64_t now_ms() const { return detail::coarse_now_ms(); }
+
+    // Slow path of prepare_publish() when the cached tail says the ring is
+    // full. There is no consumer heartbeat on the hot path, so a consumer
+    // whose tail has not moved for producer_timeout_ms is treated as dead.
+    bool make_room(int64_t timeout_ms) {
+        cached_tail = channel->tails[0].load(std::memory_order_acquire);
+        if (write_index - cached_tail < BufferSize) { stalled_since = 0; return true; }
+
+        // Nobody holds the oldest slot back: count it as free, so the next
+        // BufferSize - 1 publishes take the fast path again instead of
+        // coming back here each time.
+        if (channel->active_mask.load(std::memory_order_acquire) == 0 ||
+            settings.overflow_policy == OverflowPolicy::OVERWRITE_OLD) {
+            cached_tail = write_index - BufferSize + 1;
+            stalled_since = 0;
+            return true;
+        }
+
+        int64_t now = now_ms();
+        if (stalled_since == 0 || stalled_tail != cached_tail) {
+            stalled_since = now;
+            stalled_tail = cached_tail;
+        } else if (now - stalled_since > timeout_ms) {
+            channel->active_mask.store(0, std::memory_order_release);
+            channel->metrics.kicked.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "[NanoBroker] Auto-kicked consumer 0" << std::endl;
+            cached_tail = write_index - BufferSize + 1;
+            stalled_since = 0;
+            return true;
+        }
+
+        channel->metrics.blocked.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+public:
+    SpscBroker(const std::string &channel_name, bool create = false, int id = 0,
+               BrokerSettings custom_settings = BrokerSettings())
+        : name("/" + channel_name), channel(nullptr), is_owner(create), settings(custom_settings)
+    {
+        validate_type<T>();
+
+        detail::apply_thread_settings(settings);
+        segment.open(name, sizeof(Channel), create, settings);
+        channel = static_cast<Channel *>(segment.data());
+
+        if (create) {
+            channel->header.magic = MAGIC_NUMBER;
+            channel->header.version = PROTOCOL_VERSION;
+            std::random_device rd;
+            std::mt19937_64 gen(rd());
+            std::uniform_int_distribution<uint64_t> dis;
+            channel->header.producer_epoch = dis(gen);
+            channel->header.struct_size = sizeof(T);
+            channel->header.buffer_capacity = BufferSize;
+            detail::describe_layout(channel, ChannelKind::SPSC, 1, sizeof(T), channel->slots);
+
+            new (&channel->head) std::atomic<uint64_t>(0);
+            new (&channel->tails[0]) std::atomic<uint64_t>(0);
+            new (&channel->active_mask) std::atomic<uint64_t>(0);
+            new (&channel->consumer_blocking) std::atomic<uint32_t>(0);
+            new (&channel->owner_pids[0]) std::atomic<int32_t>(0);
+            new (&channel->heartbeats[0]) std::atomic<int64_t>(0);
+            new (&channel->signal) ChannelSignal();
+            new (&channel->metrics) ChannelMetrics<1>();
+        } else {
+
+            const SegmentHeader &header = channel->header;
+            if (header.magic != MAGIC_NUMBER) throw std::runtime_error("SHM Magic Mismatch! (Old/Corrupt Memory)");
+            if (header.version != PROTOCOL_VERSION) throw std::runtime_error("Protocol Version Mismatch!");
+            if (header.kind != ChannelKind::SPSC) throw std::runtime_error("Channel is not an SPSC channel!");
+            if (header.struct_size != sizeof(T)) throw std::runtime_error("Data Struct Size Mismatch!");
+            if (header.buffer_capacity != BufferSize) throw std::runtime_error("Buffer Size Mismatch!");
+            if (id != 0 && id != AUTO_ID) throw std::runtime_error("Invalid Consumer ID (SPSC channels have only consumer 0)");
+
+            // Same CAS and dead-holder takeover as Broker, over a single ID.
+            detail::claim_consumer_id(channel->active_mask, channel->heartbeats, channel->owner_pids, 1, 0,
+                                      settings.producer_timeout_ms);
+
+            read_index = cached_head = channel->head.load(std::memory_order_acquire);
+            channel->tails[0].store(read_index, std::memory_order_release);
+            new (&channel->metrics.consumers[0]) ConsumerMetrics();
+            channel->consumer_blocking.store(settings.wait_strategy == WaitStrategy::FUTEX,
+                                             std::memory_order_relaxed);
+        }
+    }
+
+    ~SpscBroker() {
+        if (!is_owner && channel && channel->owner_pids[0].load(std::memory_order_acquire) == self_pid) {
+            channel->consumer_blocking.store(0, std::memory_order_relaxed);
+            detail::release_consumer_id(channel->active_mask, channel->owner_pids, 0);
+        }
+    }
+
+    // Always 0 for the consumer (also with AUTO_ID); -1 for the creator.
+    int id() const { return is_owner ? -1 : 0; }
+
+    SpscBroker(const SpscBroker &) = delete;
+    SpscBroker &operator=(const SpscBroker &) = delete;
+
+    // ----- Producer -----
+
+    T *prepare_publish(int64_t timeout_ms = 2000) {
+        if (!pending) {
+            if (write_index - cached_tail >= BufferSize && !make_room(timeout_ms)) return nullptr;
+            pending = true;
+        }
+        return &channel->slots[write_index % BufferSize];
+    }
+
+    void commit_publish() {
+        if (!pending) return;
+        pending = false;
+
+        channel->head.store(++write_index, std::memory_order_release);
+        detail::count_local(channel->metrics.published);
+
+        // Only a FUTEX consumer can be asleep. The fence orders the head store
+        // before the waiters load (pairs with the waiter's RMW).
+        if (channel->consumer_blocking.load(std::memory_order_relaxed)) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (channel->signal.waiters.load(std::memory_order_relaxed) != 0) {
+                detail::notify_publish(channel->signal);
+            }
+        }
+    }
+
+    // Nothing is visible until commit, so aborting just forgets the claim.
+    void abort_publish() {
+        if (!pending) return;
+        pending = false;
+        channel->metrics.aborted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // ----- Consumer -----
+
+    const T *peek() {
+        uint64_t current_epoch = channel->header.producer_epoch;
+        if (local_epoch_cache == 0) local_epoch_cache = current_epoch;
+        if (current_epoch != local_epoch_cache) {
+            std::cerr << "[NanoBroker] Producer restarted! Resetting tail." << std::endl;
+            read_index = cached_head = channel->head.load(std::memory_order_acquire);
+            channel->tails[0].store(read_index, std::memory_order_release);
+            detail::count_local(channel->metrics.consumers[0].epoch_resets);
+            local_epoch_cache = current_epoch;
+            return nullptr;
+        }
+
+        // Read-mostly line: stays cached until the producer kicks us or a
+        // new consumer takes the ID over.
+        if (channel->active_mask.load(std::memory_order_relaxed) == 0 ||
+            channel->owner_pids[0].load(std::memory_order_relaxed) != self_pid) {
+            throw std::runtime_error("Consumer disconnected.");
+        }
+
+        if (settings.overflow_policy == OverflowPolicy::OVERWRITE_OLD || read_index == cached_head) {
+            cached_head = channel->head.load(std::memory_order_acquire);
+            if (read_index == cached_head) {
+                detail::touch_heartbeat(channel->heartbeats[0], last_heartbeat);
+                return nullptr;
+            }
+
+            // Lapped: the producer may already be writing slot cached_head,
+            // which shares a slot with cached_head - BufferSize.
+            if (settings.overflow_policy == OverflowPolicy::OVERWRITE_OLD &&
+                cached_head - read_index >= BufferSize) {
+                uint64_t oldest = cached_head - BufferSize + 1;
+                detail::count_local(channel->metrics.consumers[0].overwritten, oldest - read_index);
+                read_index = oldest;
+            }
+        }
+        return &channel->slots[read_index % BufferSize];
+    }
+
+    // Seqlock-style check for OVERWRITE_OLD: true if the producer has not
+    // started rewriting the peeked slot. Always true under BLOCK.
+    bool peek_valid() {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (channel->head.load(std::memory_order_relaxed) < read_index + BufferSize) return true;
+        detail::count_local(channel->metrics.consumers[0].torn_reads);
+        return false;
+    }
+
+    void release() {
+        channel->tails[0].store(++read_index, std::memory_order_release);
+        detail::count_local(channel->metrics.consumers[0].consumed);
+    }
+
+    const T *wait_and_peek(int64_t timeout_ms = -1) {
+        return detail::wait_for_data(settings, channel->signal, timeout_ms, [this] { return peek(); });
+    }
+
+    // Readiness probe for the consumer. Blocking on signal() only works if
+    // the consumer attached with WaitStrategy::FUTEX (see consumer_blocking).
+    bool has_data() const {
+        return !is_owner && read_index != channel->head.load(std::memory_order_acquire);
+    }
+
+    ChannelSignal &signal() { return channel->signal; }
+
+    void print_stats() {
+        uint64_t h = channel->head.load(std::memory_order_relaxed);
+        uint64_t t = channel->tails[0].load(std::memory_order_relaxed);
+        std::cout << "--- NanoBroker Stats [" << name << "] (SPSC) ---" << std::endl;
+        std::cout << "Head: " << h << std::endl;
+        if (channel->active_mask.load(std::memory_order_relaxed)) {
+            std::cout << "  [ID 0] Tail: " << t << " | Lag: " << (h - t) << std::endl;
+        }
+        std::cout << "-----------------------------------" << std::endl;
+    }
+
+    const ChannelMetrics<1> &metrics() const { return channel->metrics; }
+
+    static void unlink_memory(const std::string &name) {
+        SharedSegment::unlink("/" + name);
+    }
+};
+
+} // namespace NanoBroker
+#endif
@@ -0,0 +1,312 @@
+#ifndef NANOBROKER_TRANSFORM_HPP
+#define NANOBROKER_TRANSFORM_HPP
+
+#include "NanoBroker.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace NanoBroker {
+
+// Pixel kernels for packed 8-bit BGR, in fixed-point integer math. Luma
+// (gray and the I420 Y plane) has an SSSE3 path, compiled in with
+// NANOBROKER_NATIVE like the streaming copies; the rest is scalar.
+
+namespace detail {
+
+// dst[i] = (cb*B + cg*G + cr*R + 128) >> 8 + offset for `pixels` BGR pixels.
+// Weights must sum to at most 256 so the sums fit 16-bit lanes.
+inline void luma(const uint8_t *src, size_t pixels, uint8_t *dst, int cb, int cg, int cr, int offset) {
+    size_t i = 0;
+#if defined(__SSSE3__)
+    // Gather one channel of 16 pixels from three 16-byte loads.
+    const __m128i b0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i r0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+    const __m128i wb = _mm_set1_epi16(cb), wg = _mm_set1_epi16(cg), wr = _mm_set1_epi16(cr);
+    const __m128i round = _mm_set1_epi16(128), zero = _mm_setzero_si128(), add = _mm_set1_epi8(offset);
+
+    for (; i + 16 <= pixels; i += 16) {
+        const __m128i *p = reinterpret_cast<const __m128i *>(src + 3 * i);
+        __m128i a = _mm_loadu_si128(p), b = _mm_loadu_si128(p + 1), c = _mm_loadu_si128(p + 2);
+        __m128i blue = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, b0), _mm_shuffle_epi8(b, b1)), _mm_shuffle_epi8(c, b2));
+        __m128i green = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, g0), _mm_shuffle_epi8(b, g1)), _mm_shuffle_epi8(c, g2));
+        __m128i red = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, r0), _mm_shuffle_epi8(b, r1)), _mm_shuffle_epi8(c, r2));
+
+        __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(blue, zero), wb),
+                                                 _mm_mullo_epi16(_mm_unpacklo_epi8(green, zero), wg)),
+                                   _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(red, zero), wr), round));
+        __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(blue, zero), wb),
+                                                 _mm_mullo_epi16(_mm_unpackhi_epi8(green, zero), wg)),
+                                   _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(red, zero), wr), round));
+        __m128i y = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi8(y, add));
+    }
+#endif
+    for (; i < pixels; i++) {
+        const uint8_t *p = src + 3 * i;
+        dst[i] = static_cast<uint8_t>(((cb * p[0] + cg * p[1] + cr * p[2] + 128) >> 8) + offset);
+    }
+}
+
+} // namespace detail
+
+// 2x2 box filter: (width/2) x (height/2) BGR. dst may equal src.
+inline void downscale_bgr_2x(const uint8_t *src, int width, int height, uint8_t *dst) {
+    const int out_w = width / 2, out_h = height / 2;
+    const size_t stride = size_t(width) * 3;
+    for (int y = 0; y < out_h; y++) {
+        const uint8_t *r0 = src + size_t(2 * y) * stride;
+        const uint8_t *r1 = r0 + stride;
+        uint8_t *out = dst + size_t(y) * out_w * 3;
+        for (int x = 0; x < out_w * 3; x += 3) {
+            for (int c = 0; c < 3; c++) {
+                int i = 2 * x + c;
+                out[x + c] = static_cast<uint8_t>((r0[i] + r0[i + 3] + r1[i] + r1[i + 3] + 2) >> 2);
+            }
+        }
+    }
+}
+
+// Full-range luma (BT.601 weights), one byte per pixel. dst may equal src.
+inline void bgr_to_gray(const uint8_t *src, int width, int height, uint8_t *dst) {
+    detail::luma(src, size_t(width) * height, dst, 29, 150, 77, 0);
+}
+
+// Planar I420 (BT.601 limited range): Y, then U and V at quarter size.
+// width and height must be even; dst must not overlap src.
+inline void bgr_to_i420(const uint8_t *__restrict src, int width, int height, uint8_t *__restrict dst) {
+    uint8_t *y_plane = dst;
+    uint8_t *u_plane = dst + size_t(width) * height;
+    uint8_t *v_plane = u_plane + size_t(width / 2) * (height / 2);
+    const size_t stride = size_t(width) * 3;
+
+    detail::luma(src, size_t(width) * height, y_plane, 25, 129, 66, 16);
+
+    for (int y = 0; y < height / 2; y++) {
+        const uint8_t *r0 = src + size_t(2 * y) * stride;
+        const uint8_t *r1 = r0 + stride;
+        uint8_t *u = u_plane + size_t(y) * (width / 2);
+        uint8_t *v = v_plane + size_t(y) * (width / 2);
+        for (int x = 0; x < width / 2; x++) {
+            int i = 6 * x;
+            int b = r0[i] + r0[i + 3] + r1[i] + r1[i + 3];
+            int g = r0[i + 1] + r0[i + 4] + r1[i + 1] + r1[i + 4];
+            int r = r0[i + 2] + r0[i + 5] + r1[i + 2] + r1[i + 5];
+            u[x] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+            v[x] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+        }
+    }
+}
+
+enum class PixelOutput { BGR, GRAY, I420 };
+
+struct TransformSettings {
+    int downscale = 0;               // Halve width and height this many times
+    PixelOutput output = PixelOutput::BGR;
+};
+
+// Downscales and/or converts a BGR frame (CameraFrame's fields) into `out`.
+// Header fields are carried over. Returns false for input it cannot handle
+// (not 3-channel BGR, or too small), which a stage publishes as an abort.
+template <typename Frame>
+bool transform_frame(const Frame &in, Frame &out, const TransformSettings &settings) {
+    if (in.channels != 3 || in.width <= 0 || in.height <= 0) return false;
+    if (size_t(in.width) * in.height * 3 > sizeof(in.pixels)) return false;
+
+    int w = in.width, h = in.height;
+    const uint8_t *src = in.pixels;
+
+    // Scratch for when a conversion cannot run in place over a downscale.
+    thread_local std::vector<uint8_t> scratch;
+    bool convert_i420 = settings.output == PixelOutput::I420;
+    uint8_t *scaled = (convert_i420 && settings.downscale > 0)
+                          ? (scratch.resize(size_t(w / 2) * (h / 2) * 3), scratch.data()) : out.pixels;
+
+    for (int i = 0; i < settings.downscale && w >= 2 && h >= 2; i++) {
+        downscale_bgr_2x(src, w, h, scaled);
+        src = scaled;
+        w /= 2;
+        h /= 2;
+    }
+
+    size_t bytes = size_t(w) * h * 3;
+    switch (settings.output) {
+        case PixelOutput::BGR:
+            if (src != out.pixels) detail::stream_copy(out.pixels, src, bytes);
+            out.channels = 3;
+            out.format = "BGR";
+            break;
+        case PixelOutput::GRAY:
+            bgr_to_gray(src, w, h, out.pixels);
+            bytes = size_t(w) * h;
+            out.channels = 1;
+            out.format = "GRAY";
+            break;
+        case PixelOutput::I420:
+            w &= ~1;
+            h &= ~1;
+            if (w == 0 || h == 0) return false;
+            bgr_to_i420(src, w, h, out.pixels);
+            bytes = size_t(w) * h * 3 / 2;
+            out.channels = 1;
+            out.format = "I420";
+            break;
+    }
+
+    out.producer_id = in.producer_id;
+    out.frame_id = in.frame_id;
+    out.timestamp_ns = in.timestamp_ns;
+    out.width = w;
+    out.height = h;
+    out.data_size = bytes;
+    return true;
+}
+
+// Fixed set of threads running one parallel-for at a time. The calling
+// thread takes part, so a pool of N workers owns N - 1 threads.
+class WorkerPool {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start_cv, done_cv;
+    const std::function<void(size_t)> *job = nullptr;
+    size_t jobs = 0;
+    std::atomic<size_t> next{0};
+    uint64_t generation = 0;
+    size_t finished = 0;
+    bool stopping = false;
+
+    void drain() {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < jobs;) (*job)(i);
+    }
+
+    void work() {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start_cv.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            drain();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++finished == threads.size()) done_cv.notify_one();
+        }
+    }
+
+public:
+    explicit WorkerPool(size_t workers) {
+        for (size_t i = 1; i < workers; i++) threads.emplace_back(&WorkerPool::work, this);
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start_cv.notify_all();
+        for (auto &t : threads) t.join();
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    size_t size() const { return threads.size() + 1; }
+
+    // Calls fn(0) .. fn(n - 1) across the pool; returns when all are done.
+    void run(size_t n, const std::function<void(size_t)> &fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobs = n;
+            next.store(0, std::memory_order_relaxed);
+            finished = 0;
+            generation++;
+        }
+        start_cv.notify_all();
+        drain();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [&] { return finished == threads.size(); });
+    }
+};
+
+// Consumer that republishes a transformed copy of every frame into a derived
+// topic, e.g. a half-size grayscale feed for thumbnail consumers. Each pump
+// takes a batch of up to size() ready frames, claims one output ticket per
+// frame and transforms them in parallel on the pool, writing straight into
+// the output slots. Workers commit as they finish, out of order; consumers
+// still see frames in input order. A frame torn by an overwriting producer
+// mid-transform is aborted downstream.
+template <typename In, typename Out = In, size_t BufferSize = 30, size_t MaxConsumers = 16>
+class TransformStage {
+public:
+    using Function = std::function<bool(const In &, Out &)>;
+
+private:
+    using Output = Broker<Out, BufferSize, MaxConsumers>;
+
+    BrokerSettings settings;
+    Broker<In, BufferSize, MaxConsumers> upstream;
+    Output downstream;
+    Function transform;
+    WorkerPool pool;
+    std::vector<typename Output::Ticket> tickets;
+
+public:
+    TransformStage(const std::string &input_topic, const std::string &output_topic, Function fn,
+                   size_t workers = std::thread::hardware_concurrency(), int id = AUTO_ID,
+                   BrokerSettings custom_settings = BrokerSettings())
+        : settings(custom_settings),
+          upstream(input_topic, false, id, custom_settings),
+          downstream(output_topic, true, 0, custom_settings),
+          transform(std::move(fn)),
+          pool(std::max<size_t>(1, std::min(workers, BufferSize - 1))) {}
+
+    // Transforms and republishes one batch. Returns frames taken from the
+    // input (0 if none were ready or the output ring is full).
+    size_t pump() {
+        auto batch = upstream.peek_batch(pool.size());
+        size_t n = 0;
+        tickets.resize(batch.size());
+        for (; n < batch.size(); n++) {
+            tickets[n] = downstream.claim(settings.producer_timeout_ms);
+            if (!tickets[n]) break;
+        }
+        if (n == 0) return 0;
+
+        pool.run(n, [&](size_t i) {
+            if (transform(batch[i], *tickets[i].data) && upstream.batch_valid(i)) {
+                downstream.commit(tickets[i]);
+            } else {
+                downstream.abort(tickets[i]);
+            }
+        });
+        upstream.release_n(n);
+        return n;
+    }
+
+    // Waits on the input according to settings.wait_strategy, then pumps.
+    size_t wait_and_pump(int64_t timeout_ms = -1) {
+        if (!upstream.wait_and_peek(timeout_ms)) return 0;
+        return pump();
+    }
+
+    int id() const { return upstream.id(); }
+    size_t workers() const { return pool.size(); }
+
+    Broker<In, BufferSize, MaxConsumers> &input() { return upstream; }
+    Output &output() { return downstream; }
+};
+
+} // namespace NanoBroker
+#endif
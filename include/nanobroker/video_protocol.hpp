@@ -3,6 +3,7 @@
 
 
 #include "NanoBroker.hpp"
+#include <cstddef>
 #include <cstdint>
 
 namespace Protocol {
@@ -15,6 +16,7 @@ const size_t MAX_SIZE = MAX_WIDTH * MAX_HEIGHT * CHANNELS;
 
 const size_t BUFFER_SIZE = 30;
 const size_t MAX_CONSUMERS = 16;
+const size_t RECORD_ARENA_SIZE = 16 * 1024 * 1024; // Python RecordBroker topics
 
 struct CameraFrame {
   int producer_id;
@@ -30,6 +32,34 @@ struct CameraFrame {
   alignas(64) uint8_t pixels[MAX_SIZE];
 };
 
+// Split layout for SplitBroker<FrameHeader, FramePixels, ...>: the same
+// metadata as CameraFrame in a compact header ring, pixels in a separate
+// arena, so filtering on frame_id/timestamp_ns/producer_id never touches
+// pixel pages.
+struct FrameHeader {
+  int producer_id;
+  int frame_id;
+  int64_t timestamp_ns;
+  int width;
+  int height;
+  int channels;
+
+  size_t data_size;
+
+  NanoBroker::NanoString<16> format;
+};
+
+struct FramePixels {
+  alignas(64) uint8_t data[MAX_SIZE];
+};
+
 const std::string TOPIC_NAME = "video_stream";
 } // namespace Protocol
+
+// Relays and recorders copy the header plus data_size bytes of pixels.
+template <> struct NanoBroker::PayloadTraits<Protocol::CameraFrame> {
+  static size_t size(const Protocol::CameraFrame &frame) {
+    return offsetof(Protocol::CameraFrame, pixels) + frame.data_size;
+  }
+};
 #endif
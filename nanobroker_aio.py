@@ -0,0 +1,25 @@
+import asyncio
+
+
+async def next_frame(broker):
+    """Await the next frame from a nanobroker.VideoBroker.
+
+    Uses broker.fileno(), so one event loop can multiplex many topics
+    without a thread per topic. Returns the same tuple as get_next_frame();
+    call broker.release_frame() when done with it.
+    """
+    loop = asyncio.get_running_loop()
+    fd = broker.fileno()
+
+    while True:
+        frame = broker.try_get_frame()
+        if frame is not None:
+            return frame
+
+        ready = loop.create_future()
+        loop.add_reader(fd, lambda: ready.done() or ready.set_result(None))
+        try:
+            await ready
+        finally:
+            loop.remove_reader(fd)
+        broker.clear_notification()
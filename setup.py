@@ -4,6 +4,11 @@ import pybind11
 import os
 import glob
 
+# NANOBROKER_NATIVE=1 enables the AVX2/AVX-512 streaming copy paths
+compile_args = ['-O3', '-std=c++17']
+if os.environ.get("NANOBROKER_NATIVE"):
+    compile_args.append('-march=native')
+
 # Define the C++ extension
 ext_modules = [
     Extension(
@@ -14,7 +19,7 @@ ext_modules = [
             pybind11.get_include()
         ],
         language='c++',
-        extra_compile_args=['-O3', '-std=c++17'],
+        extra_compile_args=compile_args,
         libraries=['rt', 'pthread']
     ),
 ]
@@ -24,7 +29,7 @@ setup(
     version="1.0.0",
     description="Zero-Copy Shared Memory Video Bridge for C++ and Python",
     ext_modules=ext_modules,
-    py_modules=["nanobroker_config"],
+    py_modules=["nanobroker_config", "nanobroker_aio"],
     
     # --- NEW: This copies headers to /venv/include/nanobroker ---
     data_files=[
@@ -1,25 +1,158 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
+#include <sys/eventfd.h>
 #include "../include/nanobroker/video_protocol.hpp"
+#include "../include/nanobroker/ByteBroker.hpp"
+#include <algorithm>
+#include <memory>
 
 namespace py = pybind11;
 
+class PyFrameReservation;
+
 class PyVideoBroker {
 
+    friend class PyFrameReservation;
+
     using FrameType = Protocol::CameraFrame;
     NanoBroker::Broker<FrameType, Protocol::BUFFER_SIZE, Protocol::MAX_CONSUMERS> broker;
 
+    // fileno() support: a helper thread sleeps on the channel futex (no GIL,
+    // no CPU) and signals an eventfd an event loop can poll.
+    int notify_fd = -1;
+    std::atomic<bool> notify_stop{false};
+    std::thread notifier;
+
+    // prepare_publish() hands back the slot already pending, so a nested
+    // publish would write into (and commit) an open reserve() block's slot.
+    bool reservation_open = false;
+
+    void require_no_reservation() const {
+        if (reservation_open) throw std::runtime_error("A reserve() block is still open on this broker");
+    }
+
+    static NanoBroker::BrokerSettings make_settings(NanoBroker::WaitStrategy strategy) {
+        NanoBroker::BrokerSettings settings;
+        settings.wait_strategy = strategy;
+        return settings;
+    }
+
+    void notify_loop() {
+        while (!notify_stop.load(std::memory_order_acquire)) {
+            uint32_t seen = broker.publish_count();
+            if (broker.has_data()) {
+                uint64_t one = 1;
+                ssize_t ignored = write(notify_fd, &one, sizeof(one));
+                (void)ignored;
+            }
+            broker.wait_for_publish(seen, 100);
+        }
+    }
+
 public:
-    PyVideoBroker(const std::string& name, bool is_producer, int consumer_id) 
-        : broker(name, is_producer, consumer_id) {
+    PyVideoBroker(const std::string& name, bool is_producer, int consumer_id,
+                  NanoBroker::WaitStrategy wait_strategy = NanoBroker::WaitStrategy::HYBRID) 
+        : broker(name, is_producer, consumer_id, make_settings(wait_strategy)) {
             std::cout << "Consumer (Python) Struct Size: " << sizeof(FrameType) << std::endl;
     }
 
+    ~PyVideoBroker() {
+        if (notifier.joinable()) {
+            notify_stop.store(true, std::memory_order_release);
+            broker.wake_waiters();
+            notifier.join();
+        }
+        if (notify_fd != -1) close(notify_fd);
+    }
+
+    int consumer_id() const { return broker.id(); }
+
     // ----- Consumer API -----
-py::object get_next_frame() {
-        const FrameType* frame = broker.wait_and_peek(); 
-        
+    py::object get_next_frame(int64_t timeout_ms) {
+        const FrameType* frame = nullptr;
+        {
+            // Waiting may spin or sleep for a long time; let other Python
+            // threads run meanwhile.
+            py::gil_scoped_release release;
+            frame = broker.wait_and_peek(timeout_ms);
+        }
+        return frame_to_tuple(frame);
+    }
+
+    py::object get_latest_frame(int64_t timeout_ms) {
+        const FrameType* frame = nullptr;
+        {
+            py::gil_scoped_release release;
+            frame = broker.wait_and_peek_latest(timeout_ms);
+        }
+        return frame_to_tuple(frame);
+    }
+
+    // Like get_next_frame(), but returns an owned copy that the producer can
+    // never overwrite. The slot is released before returning.
+    py::object copy_next_frame(int64_t timeout_ms) {
+        while (true) {
+            const FrameType* frame = nullptr;
+            {
+                py::gil_scoped_release release;
+                frame = broker.wait_and_peek(timeout_ms);
+            }
+            if (!frame) return py::none();
+
+            int w = frame->width;
+            int h = frame->height;
+            int c = frame->channels;
+            size_t size = std::min<size_t>(frame->data_size, Protocol::MAX_SIZE);
+            int pid = frame->producer_id;
+            int fid = frame->frame_id;
+
+            std::vector<ssize_t> shape = { (ssize_t)size };
+            if (w > 0 && h > 0 && c > 0 && static_cast<size_t>(w * h * c) == size) {
+                shape = { (ssize_t)h, (ssize_t)w, (ssize_t)c };
+            }
+            py::array_t<uint8_t> array(shape);
+            uint8_t* dst = array.mutable_data();
+
+            bool valid;
+            {
+                py::gil_scoped_release release;
+                NanoBroker::detail::stream_copy(dst, frame->pixels, size);
+                valid = broker.peek_valid();
+                if (valid) broker.release();
+            }
+            // Torn by an overwriting producer: the metadata read above may be
+            // stale too, so start over with the next frame.
+            if (valid) return py::make_tuple(pid, fid, array);
+        }
+    }
+
+    py::object try_get_frame() {
+        const FrameType* frame = nullptr;
+        {
+            py::gil_scoped_release release;
+            frame = broker.peek();
+        }
+        return frame_to_tuple(frame);
+    }
+
+    int fileno() {
+        if (notify_fd == -1) {
+            notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (notify_fd == -1) throw std::runtime_error("eventfd failed");
+            notifier = std::thread([this] { notify_loop(); });
+        }
+        return notify_fd;
+    }
+
+    void clear_notification() {
+        if (notify_fd == -1) return;
+        uint64_t count;
+        ssize_t ignored = read(notify_fd, &count, sizeof(count));
+        (void)ignored;
+    }
+
+    py::object frame_to_tuple(const FrameType* frame) {
         if (!frame) return py::none();
 
         // Atomically snapshot metadata to avoid tearing
@@ -70,6 +203,7 @@ py::object get_next_frame() {
 
     // ------ Producer API ------
     bool publish_frame(int id, int w, int h, py::array_t<uint8_t> input_array) {
+        require_no_reservation();
 
         py::buffer_info buf = input_array.request();
 
@@ -87,7 +221,7 @@ py::object get_next_frame() {
         slot->height = h;
         
         // Copy bytes from Python Buffer to Shared Memory
-        std::memcpy(slot->pixels, buf.ptr, buf.size * sizeof(uint8_t));
+        NanoBroker::detail::stream_copy(slot->pixels, buf.ptr, buf.size * sizeof(uint8_t));
         
         auto now = std::chrono::high_resolution_clock::now();
         slot->timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
@@ -96,8 +230,224 @@ py::object get_next_frame() {
         broker.commit_publish();
         return true;
     }
+
+    PyFrameReservation reserve(int id, int w, int h, int c);
+};
+
+// Context manager returned by VideoBroker.reserve(): __enter__ claims a slot
+// and hands out a writable NumPy view over its pixels, __exit__ commits it
+// (or aborts it if the block raised).
+class PyFrameReservation {
+    PyVideoBroker *owner;
+    int id, w, h, c;
+    Protocol::CameraFrame *slot = nullptr;
+
+public:
+    PyFrameReservation(PyVideoBroker *owner, int id, int w, int h, int c)
+        : owner(owner), id(id), w(w), h(h), c(c) {}
+
+    py::array_t<uint8_t> enter() {
+        if (w <= 0 || h <= 0 || c <= 0) throw py::value_error("Frame dimensions must be positive");
+        size_t size = static_cast<size_t>(w) * h * c;
+        if (size > Protocol::MAX_SIZE) throw py::value_error("Frame too big for shared memory");
+        if (slot) throw std::runtime_error("Reservation already entered");
+        owner->require_no_reservation();
+
+        slot = owner->broker.prepare_publish();
+        if (!slot) throw py::buffer_error("NanoBroker buffer full");
+        owner->reservation_open = true;
+
+        slot->frame_id = id;
+        slot->width = w;
+        slot->height = h;
+        slot->channels = c;
+        slot->data_size = size;
+        slot->format = (c == 1) ? "GRAY" : (c == 4) ? "BGRA" : "BGR";
+
+        return py::array_t<uint8_t>(
+            { (ssize_t)h, (ssize_t)w, (ssize_t)c },
+            { (ssize_t)(w * c), (ssize_t)c, (ssize_t)1 },
+            slot->pixels,
+            py::capsule(slot, [](void* p) { })
+        );
+    }
+
+    bool exit(py::object exc_type, py::object, py::object) {
+        if (!slot) return false;
+
+        if (exc_type.is_none()) {
+            auto now = std::chrono::high_resolution_clock::now();
+            slot->timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                now.time_since_epoch()).count();
+            owner->broker.commit_publish();
+        } else {
+            owner->broker.abort_publish();
+        }
+        slot = nullptr;
+        owner->reservation_open = false;
+        return false; // Never swallow the exception
+    }
+};
+
+PyFrameReservation PyVideoBroker::reserve(int id, int w, int h, int c) {
+    require_no_reservation();
+    return PyFrameReservation(this, id, w, h, c);
+}
+
+// ------ Typed Record Channels ------
+
+// Small-record topics described by a NumPy structured dtype. Each message
+// is a run of records in a ByteBroker arena; the dtype is stored in the
+// segment header so consumers can attach without knowing it.
+class PyRecordReservation;
+
+class PyRecordBroker {
+
+    friend class PyRecordReservation;
+
+    using Channel = NanoBroker::ByteBroker<Protocol::RECORD_ARENA_SIZE, Protocol::MAX_CONSUMERS>;
+    std::unique_ptr<Channel> broker;
+    py::dtype dtype;
+
+    // The producer lock is held from reserve() entry to exit; a nested
+    // publish from the same broker would spin on it forever.
+    bool reservation_open = false;
+
+    void require_no_reservation() const {
+        if (reservation_open) throw std::runtime_error("A reserve() block is still open on this broker");
+    }
+
+    static std::string describe(const py::dtype& dt) {
+        py::object descr = py::module_::import("numpy.lib.format").attr("dtype_to_descr")(dt);
+        return py::repr(descr).cast<std::string>();
+    }
+
+    // Object fields would put PyObject pointers into shared memory, to be
+    // dereferenced in another process.
+    static void require_plain(const py::dtype& dt) {
+        if (dt.attr("hasobject").cast<bool>()) {
+            throw py::value_error("Record dtype must not contain Python object fields");
+        }
+    }
+
+    static py::dtype parse(const std::string& schema) {
+        py::object descr = py::module_::import("ast").attr("literal_eval")(schema);
+        return py::module_::import("numpy.lib.format").attr("descr_to_dtype")(descr).cast<py::dtype>();
+    }
+
+    py::array view(const uint8_t* data, size_t bytes, bool writable) {
+        ssize_t count = static_cast<ssize_t>(bytes / dtype.itemsize());
+        py::array array(dtype, { count }, data, py::capsule(data, [](void* p) { }));
+        if (!writable) array.attr("setflags")(py::arg("write") = false);
+        return array;
+    }
+
+public:
+    PyRecordBroker(const std::string& name, py::object dtype_like, bool is_producer, int consumer_id,
+                   NanoBroker::WaitStrategy wait_strategy) {
+        NanoBroker::BrokerSettings settings;
+        settings.wait_strategy = wait_strategy;
+
+        if (is_producer) {
+            if (dtype_like.is_none()) throw py::value_error("A producer must provide the record dtype");
+            dtype = py::dtype::from_args(dtype_like);
+            require_plain(dtype);
+            broker = std::make_unique<Channel>(name, true, 0, settings, describe(dtype));
+        } else {
+            broker = std::make_unique<Channel>(name, false, consumer_id, settings);
+            if (broker->schema().empty()) throw std::runtime_error("Topic has no record dtype");
+            dtype = parse(broker->schema());
+            require_plain(dtype);
+            if (!dtype_like.is_none() && !dtype.equal(py::dtype::from_args(dtype_like))) {
+                throw py::value_error("dtype does not match the topic's record layout");
+            }
+        }
+    }
+
+    py::dtype get_dtype() const { return dtype; }
+    int consumer_id() const { return broker->id(); }
+
+    // ----- Consumer API -----
+    py::object get_next(int64_t timeout_ms) {
+        NanoBroker::ByteView record;
+        {
+            py::gil_scoped_release release;
+            record = broker->wait_and_peek(timeout_ms);
+        }
+        if (!record) return py::none();
+        return view(record.data, record.size, false);
+    }
+
+    py::object try_get() {
+        NanoBroker::ByteView record;
+        {
+            // peek() may spin briefly on a record that is still being written.
+            py::gil_scoped_release release;
+            record = broker->peek();
+        }
+        if (!record) return py::none();
+        return view(record.data, record.size, false);
+    }
+
+    void release() { broker->release(); }
+
+    // ----- Producer API -----
+    bool publish(py::array records) {
+        require_no_reservation();
+        py::array contiguous = py::array::ensure(records, py::array::c_style);
+        if (!contiguous || !contiguous.dtype().equal(dtype)) {
+            throw py::value_error("records must be an array of the topic's dtype");
+        }
+        size_t bytes = static_cast<size_t>(contiguous.nbytes());
+        if (bytes > Channel::max_record_size()) throw py::value_error("Message too big for the record arena");
+
+        uint8_t* slot = broker->prepare_publish(bytes);
+        if (!slot) return false;
+        std::memcpy(slot, contiguous.data(), bytes);
+        broker->commit_publish();
+        return true;
+    }
+
+    PyRecordReservation reserve(size_t count);
 };
 
+class PyRecordReservation {
+    PyRecordBroker *owner;
+    size_t count;
+    uint8_t *slot = nullptr;
+
+public:
+    PyRecordReservation(PyRecordBroker *owner, size_t count) : owner(owner), count(count) {}
+
+    py::array enter() {
+        size_t bytes = count * static_cast<size_t>(owner->dtype.itemsize());
+        if (bytes > PyRecordBroker::Channel::max_record_size()) {
+            throw py::value_error("Message too big for the record arena");
+        }
+        if (slot) throw std::runtime_error("Reservation already entered");
+        owner->require_no_reservation();
+
+        slot = owner->broker->prepare_publish(bytes);
+        if (!slot) throw py::buffer_error("NanoBroker buffer full");
+        owner->reservation_open = true;
+        return owner->view(slot, bytes, true);
+    }
+
+    bool exit(py::object exc_type, py::object, py::object) {
+        if (!slot) return false;
+        if (exc_type.is_none()) owner->broker->commit_publish();
+        else owner->broker->abort_publish();
+        slot = nullptr;
+        owner->reservation_open = false;
+        return false;
+    }
+};
+
+PyRecordReservation PyRecordBroker::reserve(size_t count) {
+    require_no_reservation();
+    return PyRecordReservation(this, count);
+}
+
 // ------ Python Module Definition ------
 
 
@@ -110,23 +460,49 @@ PYBIND11_MODULE(nanobroker, m) {
     )pbdoc";
 
     m.attr("DEFAULT_TOPIC") = Protocol::TOPIC_NAME; 
+    m.attr("AUTO_ID") = NanoBroker::AUTO_ID;
+
+    py::class_<PyRecordReservation>(m, "RecordReservation")
+        .def("__enter__", &PyRecordReservation::enter)
+        .def("__exit__", &PyRecordReservation::exit);
+
+    py::class_<PyFrameReservation>(m, "FrameReservation")
+        .def("__enter__", &PyFrameReservation::enter)
+        .def("__exit__", &PyFrameReservation::exit);
+
+    py::enum_<NanoBroker::WaitStrategy>(m, "WaitStrategy")
+        .value("SPIN", NanoBroker::WaitStrategy::SPIN)
+        .value("HYBRID", NanoBroker::WaitStrategy::HYBRID)
+        .value("FUTEX", NanoBroker::WaitStrategy::FUTEX);
 
     py::class_<PyVideoBroker>(m, "VideoBroker")
-        .def(py::init<std::string, bool, int>(), 
+        .def(py::init<std::string, bool, int, NanoBroker::WaitStrategy>(), 
             py::arg("topic"), py::arg("is_producer") = false, py::arg("consumer_id") = 0,
+            py::arg("wait_strategy") = NanoBroker::WaitStrategy::HYBRID,
             R"pbdoc(
                 Connect to a NanoBroker topic.
                 
                 Args:
                     topic (str): The shared memory name (e.g. "video_stream").
                     is_producer (bool): Set True if you intend to write data (Master).
-                    consumer_id (int): Unique ID (0-15) for this consumer process.
+                    consumer_id (int): Unique ID (0-15) for this consumer process,
+                                     or AUTO_ID to claim a free one (see .consumer_id).
+                                     Raises if the ID is held by a live process.
                                      Ignored if is_producer is True.
+                    wait_strategy (WaitStrategy): How get_next_frame() waits.
+                                     FUTEX sleeps in the kernel (near-zero idle CPU).
             )pbdoc"
         )
+        .def_property_readonly("consumer_id", &PyVideoBroker::consumer_id,
+            "Consumer ID in use (-1 for the producer).")
         .def("get_next_frame", &PyVideoBroker::get_next_frame,
+            py::arg("timeout_ms") = -1,
             R"pbdoc(
                 Wait for the next available frame (Zero-Copy).
+                The GIL is released while waiting.
+
+                Args:
+                    timeout_ms (int): Give up after this many ms (-1 = wait forever).
                 
                 Returns:
                     tuple: (producer_id, frame_id, numpy_array) OR None if empty.
@@ -135,6 +511,46 @@ PYBIND11_MODULE(nanobroker, m) {
                     It is read-only unless you explicitly .copy() it.
             )pbdoc"
         )
+        .def("get_latest_frame", &PyVideoBroker::get_latest_frame,
+            py::arg("timeout_ms") = -1,
+            R"pbdoc(
+                Like get_next_frame(), but returns the newest frame and skips
+                any older unread ones. For previews and loops that cannot keep
+                up with the producer; a slow reader no longer lags or (under
+                BLOCK) throttles it. Call release_frame() as usual.
+            )pbdoc"
+        )
+        .def("copy_next_frame", &PyVideoBroker::copy_next_frame,
+            py::arg("timeout_ms") = -1,
+            R"pbdoc(
+                Wait for the next frame and return an owned copy of it.
+                The copy is validated against concurrent overwrites (OVERWRITE_OLD)
+                and the frame is already released; do not call release_frame().
+                Faster than np.copy() on the zero-copy view for large frames.
+
+                Returns:
+                    tuple: (producer_id, frame_id, numpy_array) OR None on timeout.
+            )pbdoc"
+        )
+        .def("try_get_frame", &PyVideoBroker::try_get_frame,
+            R"pbdoc(
+                Non-blocking get_next_frame(): returns None immediately if no frame is ready.
+            )pbdoc"
+        )
+        .def("fileno", &PyVideoBroker::fileno,
+            R"pbdoc(
+                File descriptor that becomes readable when frames are available.
+
+                Lets one event loop (asyncio add_reader, select, poll) watch many
+                topics. After it fires, call clear_notification() and drain with
+                try_get_frame(). See nanobroker_aio.next_frame() for an awaitable.
+            )pbdoc"
+        )
+        .def("clear_notification", &PyVideoBroker::clear_notification,
+            R"pbdoc(
+                Reset the fileno() descriptor after it fired.
+            )pbdoc"
+        )
         .def("release_frame", &PyVideoBroker::release_frame,
             R"pbdoc(
                 Release the current slot so the producer can reuse it.
@@ -154,5 +570,88 @@ PYBIND11_MODULE(nanobroker, m) {
                 Returns:
                     bool: True if successful, False if buffer full.
             )pbdoc"
+        )
+        .def("reserve", &PyVideoBroker::reserve,
+            py::arg("id"), py::arg("w"), py::arg("h"), py::arg("c") = 3,
+            py::keep_alive<0, 1>(),
+            R"pbdoc(
+                Reserve a slot and render straight into shared memory (Zero-Copy).
+
+                    with broker.reserve(frame_id, 640, 480) as img:
+                        img[:] = 0
+                        cv2.circle(img, (320, 240), 50, (0, 0, 255), -1)
+
+                Entering yields a writable (h, w, c) uint8 view over the slot
+                and raises BufferError if the buffer is full. Leaving the
+                block commits the frame, or discards it if the block raised.
+                Do not keep the array after the block ends. Calling reserve() or
+                publish_frame() on the same broker inside the block raises
+                RuntimeError.
+
+                Args:
+                    id (int): Frame Sequence ID.
+                    w (int): Width.
+                    h (int): Height.
+                    c (int): Channels (default 3).
+            )pbdoc"
+        );
+
+    py::class_<PyRecordBroker>(m, "RecordBroker")
+        .def(py::init<std::string, py::object, bool, int, NanoBroker::WaitStrategy>(),
+            py::arg("topic"), py::arg("dtype") = py::none(), py::arg("is_producer") = false,
+            py::arg("consumer_id") = 0, py::arg("wait_strategy") = NanoBroker::WaitStrategy::HYBRID,
+            R"pbdoc(
+                Connect to a typed record topic (IMU samples, detections, ...).
+
+                Args:
+                    topic (str): The shared memory name.
+                    dtype (numpy.dtype): Record layout, usually a structured dtype.
+                                     Required for the producer; stored in the topic
+                                     header so consumers may omit it (if given it
+                                     is checked against the header).
+                    is_producer (bool): Set True to create the topic and write.
+                    consumer_id (int): Unique ID (0-15) for this consumer process,
+                                     or AUTO_ID to claim a free one.
+                    wait_strategy (WaitStrategy): How get_next() waits.
+            )pbdoc"
+        )
+        .def_property_readonly("consumer_id", &PyRecordBroker::consumer_id,
+            "Consumer ID in use (-1 for the producer).")
+        .def_property_readonly("dtype", &PyRecordBroker::get_dtype,
+            "Record dtype of the topic.")
+        .def("get_next", &PyRecordBroker::get_next, py::arg("timeout_ms") = -1,
+            R"pbdoc(
+                Wait for the next message (Zero-Copy). The GIL is released while waiting.
+
+                Returns:
+                    numpy.ndarray: Read-only 1-D array of records viewing shared memory,
+                    or None on timeout. Call release() when done with it.
+            )pbdoc"
+        )
+        .def("try_get", &PyRecordBroker::try_get,
+            "Non-blocking get_next(): returns None immediately if nothing is ready.")
+        .def("release", &PyRecordBroker::release,
+            "Release the current message so its space can be reused.")
+        .def("publish", &PyRecordBroker::publish, py::arg("records"),
+            R"pbdoc(
+                Copy an array of records (or a single record) into one message.
+
+                Returns:
+                    bool: True if successful, False if buffer full.
+            )pbdoc"
+        )
+        .def("reserve", &PyRecordBroker::reserve, py::arg("count") = 1,
+            py::keep_alive<0, 1>(),
+            R"pbdoc(
+                Reserve a message of `count` records and write fields in place.
+
+                    with broker.reserve(1) as rec:
+                        rec["t"] = time.monotonic_ns()
+                        rec["accel"] = (0.0, 0.0, 9.81)
+
+                Commits on exit, discards if the block raised; raises BufferError
+                if the buffer is full. Calling reserve() or publish() on the same
+                broker inside the block raises RuntimeError.
+            )pbdoc"
         );
-}
\ No newline at end of file
+}
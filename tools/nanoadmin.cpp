@@ -1,14 +1,55 @@
+#include "nanobroker/SegmentInspector.hpp"
 #include "nanobroker/video_protocol.hpp"
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 void print_help() {
     std::cout << "Usage: nanoadmin <command> [args]\n"
               << "Commands:\n"
-              << "  stats       Show buffer status and active consumers\n"
-              << "  kick <id>   Forcefully remove a dead consumer ID\n"
-              << "  clean       Delete the shared memory file (Fix startup error)\n";
+              << "  list [ms]             List all segments with lag and msg/s measured over ms (default 1000)\n"
+              << "  stats [topic]         Show buffer status and active consumers\n"
+              << "  metrics [topic] [--interval ms]\n"
+              << "                        Show counters, lag and latency (repeat every ms)\n"
+              << "  kick <id> [topic]     Forcefully remove a dead consumer ID\n"
+              << "  clean [topic]         Delete the shared memory file (Fix startup error)\n"
+              << "topic defaults to " << Protocol::TOPIC_NAME << "\n";
+}
+
+int list_topics(int interval_ms) {
+    std::vector<std::unique_ptr<NanoBroker::SegmentInspector>> segments;
+    for (const auto &topic : NanoBroker::SegmentInspector::list()) {
+        try {
+            segments.emplace_back(new NanoBroker::SegmentInspector(topic));
+        } catch (const std::exception &e) {
+            std::cerr << topic << ": " << e.what() << std::endl;
+        }
+    }
+
+    std::vector<uint64_t> before;
+    for (const auto &s : segments) before.push_back(s->metrics().published.load(std::memory_order_relaxed));
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+
+    std::cout << std::left << std::setw(24) << "TOPIC" << std::setw(7) << "KIND" << std::setw(12) << "CAPACITY"
+              << std::setw(11) << "CONSUMERS" << std::setw(14) << "MAX_LAG" << "MSG/S" << std::endl;
+    for (size_t i = 0; i < segments.size(); i++) {
+        const auto &s = *segments[i];
+        const auto &info = s.layout();
+        bool bytes = info.kind == NanoBroker::ChannelKind::BYTES;
+
+        size_t consumers = 0;
+        for (size_t id = 0; id < info.max_consumers; id++) consumers += s.is_active(id);
+        uint64_t published = s.metrics().published.load(std::memory_order_relaxed) - before[i];
+
+        std::cout << std::left << std::setw(24) << s.topic().substr(1) << std::setw(7) << s.kind_name()
+                  << std::setw(12) << info.buffer_capacity << std::setw(11) << consumers
+                  << std::setw(14) << (std::to_string(s.max_lag()) + (bytes ? "B" : ""))
+                  << (interval_ms > 0 ? published * 1000 / interval_ms : 0) << std::endl;
+    }
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
@@ -21,26 +62,48 @@ int main(int argc, char* argv[]) {
     std::string topic = Protocol::TOPIC_NAME; // "video_stream"
 
     try {
-        if (command == "clean") {
+        if (command == "list") {
+            return list_topics((argc >= 3) ? std::stoi(argv[2]) : 1000);
+        }
 
-            NanoBroker::Broker<Protocol::CameraFrame, Protocol::BUFFER_SIZE>::unlink_memory(topic);
+        if (command == "clean") {
+            if (argc >= 3) topic = argv[2];
+            NanoBroker::SharedSegment::unlink("/" + topic);
             return 0;
         }
 
-
-        NanoBroker::Broker<Protocol::CameraFrame, Protocol::BUFFER_SIZE, Protocol::MAX_CONSUMERS> 
-    broker(topic, false, -99);
-
-        if (command == "stats") {
-            broker.print_stats();
-        } 
-        else if (command == "kick") {
+        if (command == "kick") {
             if (argc < 3) {
                 std::cerr << "Error: Provide consumer ID to kick.\n";
                 return 1;
             }
             int id = std::stoi(argv[2]);
-            broker.force_disconnect_consumer(id);
+            if (argc >= 4) topic = argv[3];
+            NanoBroker::SegmentInspector(topic).force_disconnect_consumer(id);
+            return 0;
+        }
+
+        if (command == "metrics") {
+            int interval_ms = 0;
+            for (int i = 2; i < argc; i++) {
+                std::string arg = argv[i];
+                if (arg == "--interval" && i + 1 < argc) interval_ms = std::stoi(argv[++i]);
+                else if (arg.rfind("--", 0) == 0) { print_help(); return 1; }
+                else topic = arg;
+            }
+            NanoBroker::SegmentInspector segment(topic);
+            do {
+                segment.print_metrics();
+                std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+            } while (interval_ms > 0);
+            return 0;
+        }
+
+        if (argc >= 3) topic = argv[2];
+        NanoBroker::SegmentInspector segment(topic);
+
+        if (command == "stats") {
+            segment.print_stats();
         }
         else {
             print_help();
@@ -53,4 +116,4 @@ int main(int argc, char* argv[]) {
     }
 
     return 0;
-}
\ No newline at end of file
+}
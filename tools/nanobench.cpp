@@ -0,0 +1,359 @@
+#include "nanobroker/NanoBroker.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <vector>
+
+// Forks one producer and N consumer processes over a Broker and reports
+// end-to-end latency (commit -> peek, from timestamp_ns) and throughput.
+// Payload size and BufferSize are template parameters of Broker, so only
+// the sizes compiled in below can be swept.
+
+namespace {
+
+const size_t BENCH_MAX_CONSUMERS = 16;
+const size_t MAX_SEGMENT_BYTES = 512ull * 1024 * 1024;
+
+template <size_t PayloadBytes>
+struct BenchMessage {
+    uint64_t index;
+    int64_t timestamp_ns;
+    uint32_t stop;
+    alignas(64) uint8_t payload[PayloadBytes];
+};
+
+struct Case {
+    size_t payload;
+    size_t buffer;
+    int consumers;
+    NanoBroker::OverflowPolicy policy;
+    NanoBroker::WaitStrategy wait;
+    uint64_t messages;
+    uint64_t rate; // Messages per second, 0 = as fast as possible
+};
+
+struct ProducerResult {
+    uint64_t published = 0;
+    uint64_t blocked = 0; // prepare_publish() calls refused under BLOCK
+    int64_t elapsed_ns = 0;
+};
+
+struct ConsumerResult {
+    uint64_t received = 0;
+    uint64_t dropped = 0; // Index gaps, i.e. frames overwritten before we got them
+    int64_t p50_ns = 0;
+    int64_t p99_ns = 0;
+    int64_t p999_ns = 0;
+    int64_t max_ns = 0;
+    uint64_t checksum = 0;
+};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *policy_name(NanoBroker::OverflowPolicy p) {
+    return p == NanoBroker::OverflowPolicy::BLOCK ? "block" : "overwrite";
+}
+
+const char *wait_name(NanoBroker::WaitStrategy w) {
+    switch (w) {
+    case NanoBroker::WaitStrategy::SPIN: return "spin";
+    case NanoBroker::WaitStrategy::HYBRID: return "hybrid";
+    default: return "futex";
+    }
+}
+
+bool write_all(int fd, const void *data, size_t size) {
+    const char *p = static_cast<const char *>(data);
+    while (size) {
+        ssize_t n = write(fd, p, size);
+        if (n <= 0) return false;
+        p += n; size -= n;
+    }
+    return true;
+}
+
+bool read_all(int fd, void *data, size_t size) {
+    char *p = static_cast<char *>(data);
+    while (size) {
+        ssize_t n = read(fd, p, size);
+        if (n <= 0) return false;
+        p += n; size -= n;
+    }
+    return true;
+}
+
+int64_t percentile(const std::vector<int64_t> &sorted, double q) {
+    if (sorted.empty()) return 0;
+    size_t i = static_cast<size_t>(q * (sorted.size() - 1));
+    return sorted[i];
+}
+
+template <size_t P, size_t B>
+void run_consumer(const std::string &topic, int id, const Case &c, int ready_fd, int result_fd) {
+    using Message = BenchMessage<P>;
+    NanoBroker::BrokerSettings settings;
+    settings.wait_strategy = c.wait;
+    NanoBroker::Broker<Message, B, BENCH_MAX_CONSUMERS> broker(topic, false, id, settings);
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(c.messages);
+    ConsumerResult result;
+    uint64_t expected = 0;
+
+    char ready = 1;
+    write_all(ready_fd, &ready, 1);
+
+    while (true) {
+        const Message *msg = broker.wait_and_peek(5000);
+        if (!msg) break; // Producer gone
+        int64_t latency = now_ns() - msg->timestamp_ns;
+        if (msg->stop) { broker.release(); break; }
+
+        // Read one word per cache line so the payload really crosses cores.
+        for (size_t off = 0; off < P; off += 64) result.checksum += msg->payload[off];
+
+        if (msg->index > expected) result.dropped += msg->index - expected;
+        expected = msg->index + 1;
+        latencies.push_back(latency);
+        result.received++;
+        broker.release();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    result.p50_ns = percentile(latencies, 0.50);
+    result.p99_ns = percentile(latencies, 0.99);
+    result.p999_ns = percentile(latencies, 0.999);
+    result.max_ns = latencies.empty() ? 0 : latencies.back();
+    write_all(result_fd, &result, sizeof(result));
+}
+
+template <size_t P, size_t B>
+void run_producer(const std::string &topic, const Case &c, int result_fd) {
+    using Message = BenchMessage<P>;
+    NanoBroker::BrokerSettings settings;
+    settings.overflow_policy = c.policy;
+    NanoBroker::Broker<Message, B, BENCH_MAX_CONSUMERS> broker(topic, false, -99, settings);
+
+    ProducerResult result;
+    int64_t start = now_ns();
+    int64_t interval = c.rate ? 1000000000ll / static_cast<int64_t>(c.rate) : 0;
+
+    for (uint64_t i = 0; i <= c.messages; i++) {
+        if (interval) {
+            int64_t due = start + static_cast<int64_t>(i) * interval;
+            while (now_ns() < due) _mm_pause();
+        }
+
+        Message *msg;
+        while ((msg = broker.prepare_publish()) == nullptr) { result.blocked++; std::this_thread::yield(); }
+
+        bool stop = (i == c.messages);
+        if (!stop) std::memset(msg->payload, static_cast<int>(i), P);
+        msg->index = i;
+        msg->stop = stop;
+        msg->timestamp_ns = now_ns();
+        broker.commit_publish();
+        if (!stop) result.published++;
+    }
+
+    result.elapsed_ns = now_ns() - start;
+    write_all(result_fd, &result, sizeof(result));
+}
+
+template <size_t P, size_t B>
+bool run_case(const Case &c, bool json) {
+    using Message = BenchMessage<P>;
+    using Channel = NanoBroker::SharedChannel<Message, B, BENCH_MAX_CONSUMERS>;
+    if (sizeof(Channel) > MAX_SEGMENT_BYTES) return false;
+
+    std::string topic = "nanobench_" + std::to_string(getpid());
+    NanoBroker::Broker<Message, B, BENCH_MAX_CONSUMERS> owner(topic, true);
+
+    int ready_pipe[2], result_pipe[2];
+    if (pipe(ready_pipe) != 0 || pipe(result_pipe) != 0) throw std::runtime_error("pipe failed");
+
+    std::vector<pid_t> children;
+    for (int i = 0; i < c.consumers; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_consumer<P, B>(topic, i, c, ready_pipe[1], result_pipe[1]);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+
+    for (int i = 0; i < c.consumers; i++) {
+        char ready;
+        read_all(ready_pipe[0], &ready, 1);
+    }
+
+    int producer_pipe[2];
+    if (pipe(producer_pipe) != 0) throw std::runtime_error("pipe failed");
+    pid_t producer = fork();
+    if (producer == 0) {
+        run_producer<P, B>(topic, c, producer_pipe[1]);
+        _exit(0);
+    }
+    children.push_back(producer);
+
+    ProducerResult prod;
+    read_all(producer_pipe[0], &prod, sizeof(prod));
+
+    std::vector<ConsumerResult> results(c.consumers);
+    for (auto &r : results) read_all(result_pipe[0], &r, sizeof(r));
+
+    for (pid_t pid : children) waitpid(pid, nullptr, 0);
+    for (int fd : {ready_pipe[0], ready_pipe[1], result_pipe[0], result_pipe[1],
+                   producer_pipe[0], producer_pipe[1]}) close(fd);
+    NanoBroker::Broker<Message, B, BENCH_MAX_CONSUMERS>::unlink_memory(topic);
+
+    // Report the worst consumer for every latency figure.
+    ConsumerResult worst;
+    uint64_t min_received = results.empty() ? 0 : UINT64_MAX;
+    uint64_t dropped = 0;
+    for (const auto &r : results) {
+        worst.p50_ns = std::max(worst.p50_ns, r.p50_ns);
+        worst.p99_ns = std::max(worst.p99_ns, r.p99_ns);
+        worst.p999_ns = std::max(worst.p999_ns, r.p999_ns);
+        worst.max_ns = std::max(worst.max_ns, r.max_ns);
+        min_received = std::min(min_received, r.received);
+        dropped += r.dropped;
+    }
+
+    double seconds = prod.elapsed_ns / 1e9;
+    double msgs_per_s = seconds > 0 ? prod.published / seconds : 0;
+    double gb_per_s = msgs_per_s * P / 1e9;
+
+    if (json) {
+        std::printf("{\"payload_bytes\":%zu,\"buffer_size\":%zu,\"consumers\":%d,\"policy\":\"%s\","
+                    "\"wait\":\"%s\",\"messages\":%llu,\"msgs_per_s\":%.1f,\"gb_per_s\":%.3f,"
+                    "\"blocked\":%llu,\"min_received\":%llu,\"dropped\":%llu,"
+                    "\"p50_us\":%.3f,\"p99_us\":%.3f,\"p999_us\":%.3f,\"max_us\":%.3f}\n",
+                    P, B, c.consumers, policy_name(c.policy), wait_name(c.wait),
+                    (unsigned long long)prod.published, msgs_per_s, gb_per_s,
+                    (unsigned long long)prod.blocked, (unsigned long long)min_received,
+                    (unsigned long long)dropped, worst.p50_ns / 1e3, worst.p99_ns / 1e3,
+                    worst.p999_ns / 1e3, worst.max_ns / 1e3);
+    } else {
+        std::printf("%zu,%zu,%d,%s,%s,%llu,%.1f,%.3f,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.3f\n",
+                    P, B, c.consumers, policy_name(c.policy), wait_name(c.wait),
+                    (unsigned long long)prod.published, msgs_per_s, gb_per_s,
+                    (unsigned long long)prod.blocked, (unsigned long long)min_received,
+                    (unsigned long long)dropped, worst.p50_ns / 1e3, worst.p99_ns / 1e3,
+                    worst.p999_ns / 1e3, worst.max_ns / 1e3);
+    }
+    std::fflush(stdout);
+    return true;
+}
+
+template <size_t P>
+bool dispatch_buffer(const Case &c, bool json) {
+    switch (c.buffer) {
+    case 8: return run_case<P, 8>(c, json);
+    case 32: return run_case<P, 32>(c, json);
+    case 128: return run_case<P, 128>(c, json);
+    default: return false;
+    }
+}
+
+bool dispatch(const Case &c, bool json) {
+    switch (c.payload) {
+    case 64: return dispatch_buffer<64>(c, json);
+    case 4096: return dispatch_buffer<4096>(c, json);
+    case 65536: return dispatch_buffer<65536>(c, json);
+    case 1048576: return dispatch_buffer<1048576>(c, json);
+    case 6220800: return dispatch_buffer<6220800>(c, json); // 1920x1080x3
+    default: return false;
+    }
+}
+
+std::vector<std::string> split(const std::string &list) {
+    std::vector<std::string> out;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) if (!item.empty()) out.push_back(item);
+    return out;
+}
+
+void print_help() {
+    std::cout << "Usage: nanobench [options]\n"
+              << "  --sizes <list>      Payload bytes (64,4096,65536,1048576,6220800)\n"
+              << "  --buffers <list>    BufferSize (8,32,128)\n"
+              << "  --consumers <list>  Consumer process counts (default 1,4)\n"
+              << "  --policies <list>   block,overwrite\n"
+              << "  --waits <list>      spin,hybrid,futex\n"
+              << "  --messages <n>      Messages per case (capped at 4 GB of payload)\n"
+              << "  --rate <n>          Publish rate in msgs/s (0 = unbounded)\n"
+              << "  --json              JSON lines instead of CSV\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> sizes = {"64", "4096", "65536", "1048576", "6220800"};
+    std::vector<std::string> buffers = {"8", "32", "128"};
+    std::vector<std::string> consumers = {"1", "4"};
+    std::vector<std::string> policies = {"block", "overwrite"};
+    std::vector<std::string> waits = {"spin", "hybrid", "futex"};
+    uint64_t messages = 100000;
+    uint64_t rate = 0;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--sizes" && has_value) sizes = split(argv[++i]);
+        else if (arg == "--buffers" && has_value) buffers = split(argv[++i]);
+        else if (arg == "--consumers" && has_value) consumers = split(argv[++i]);
+        else if (arg == "--policies" && has_value) policies = split(argv[++i]);
+        else if (arg == "--waits" && has_value) waits = split(argv[++i]);
+        else if (arg == "--messages" && has_value) messages = std::stoull(argv[++i]);
+        else if (arg == "--rate" && has_value) rate = std::stoull(argv[++i]);
+        else if (arg == "--json") json = true;
+        else { print_help(); return 1; }
+    }
+
+    if (!json) {
+        std::printf("payload_bytes,buffer_size,consumers,policy,wait,messages,msgs_per_s,gb_per_s,"
+                    "blocked,min_received,dropped,p50_us,p99_us,p999_us,max_us\n");
+    }
+
+    try {
+        for (const auto &size : sizes)
+        for (const auto &buffer : buffers)
+        for (const auto &count : consumers)
+        for (const auto &policy : policies)
+        for (const auto &wait : waits) {
+            Case c;
+            c.payload = std::stoull(size);
+            c.buffer = std::stoull(buffer);
+            c.consumers = std::stoi(count);
+            c.policy = (policy == "overwrite") ? NanoBroker::OverflowPolicy::OVERWRITE_OLD
+                                               : NanoBroker::OverflowPolicy::BLOCK;
+            c.wait = (wait == "spin") ? NanoBroker::WaitStrategy::SPIN
+                   : (wait == "futex") ? NanoBroker::WaitStrategy::FUTEX
+                                       : NanoBroker::WaitStrategy::HYBRID;
+            c.messages = std::min<uint64_t>(messages, std::max<uint64_t>(100, (4ull << 30) / c.payload));
+            c.rate = rate;
+
+            if (c.consumers < 1 || c.consumers > static_cast<int>(BENCH_MAX_CONSUMERS)) {
+                std::cerr << "Skipping consumers=" << count << " (1-" << BENCH_MAX_CONSUMERS << ")\n";
+                continue;
+            }
+            if (!dispatch(c, json)) {
+                std::cerr << "Skipping payload=" << size << " buffer=" << buffer
+                          << " (not compiled in, or segment over " << (MAX_SEGMENT_BYTES >> 20) << " MB)\n";
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "nanobroker/Bridge.hpp"
+#include "nanobroker/video_protocol.hpp"
+#include <csignal>
+#include <iostream>
+#include <string>
+
+using Sender = NanoBroker::BridgeSender<Protocol::CameraFrame, Protocol::BUFFER_SIZE, Protocol::MAX_CONSUMERS>;
+using Receiver = NanoBroker::BridgeReceiver<Protocol::CameraFrame, Protocol::BUFFER_SIZE, Protocol::MAX_CONSUMERS>;
+
+std::atomic<bool> running{true};
+
+void stop(int) { running = false; }
+
+void print_help() {
+    std::cout << "Usage: nanobridge <command> [args]\n"
+              << "Commands:\n"
+              << "  send <topic> <endpoint> [--batch N] [--zerocopy]  Stream a topic to a receiver\n"
+              << "  recv <endpoint> <topic>                           Republish a sender's stream locally\n"
+              << "endpoint is tcp:host:port (tcp:*:port to listen on all interfaces) or unix:/path\n";
+}
+
+int run_sender(const std::string &topic, const std::string &endpoint, size_t batch, bool zerocopy) {
+    NanoBroker::BrokerSettings settings;
+    settings.wait_strategy = NanoBroker::WaitStrategy::FUTEX;
+    Sender sender(topic, endpoint, batch, zerocopy, NanoBroker::AUTO_ID, settings);
+    std::cout << "[Bridge] " << topic << " -> " << endpoint << " as consumer " << sender.id()
+              << (sender.zerocopy_enabled() ? " (MSG_ZEROCOPY)" : "") << std::endl;
+
+    while (running) sender.wait_and_pump(100, &running);
+
+    std::cout << "[Bridge] Sent " << sender.sent() << " messages";
+    if (sender.torn_sends()) std::cout << ", " << sender.torn_sends() << " overwritten while sending";
+    if (sender.zerocopy_copied()) std::cout << ", " << sender.zerocopy_copied() << " zerocopy sends copied";
+    std::cout << std::endl;
+    return 0;
+}
+
+int run_receiver(const std::string &endpoint, const std::string &topic) {
+    Receiver receiver(endpoint, topic);
+    // Short poll timeouts keep an idle receiver responsive to Ctrl-C.
+    while (running) {
+        std::cout << "[Bridge] Waiting for a sender on " << endpoint << std::endl;
+        while (running && !receiver.accept_sender(100)) {}
+        if (!running) break;
+        std::cout << "[Bridge] Sender connected, publishing to " << topic << std::endl;
+        while (running && (!receiver.poll_data(100) || receiver.pump())) {}
+        std::cout << "[Bridge] Sender gone after " << receiver.messages() << " messages ("
+                  << receiver.drops() << " dropped on a full ring)" << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        print_help();
+        return 1;
+    }
+
+    std::string command = argv[1];
+    // No SA_RESTART (std::signal sets it on glibc), so a blocking poll or
+    // recv returns EINTR and the loops see the flag.
+    struct sigaction action {};
+    action.sa_handler = stop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    try {
+        if (command == "send") {
+            size_t batch = 64;
+            bool zerocopy = false;
+            for (int i = 4; i < argc; i++) {
+                std::string arg = argv[i];
+                if (arg == "--batch" && i + 1 < argc) batch = std::stoul(argv[++i]);
+                else if (arg == "--zerocopy") zerocopy = true;
+                else { print_help(); return 1; }
+            }
+            return run_sender(argv[2], argv[3], batch, zerocopy);
+        }
+        if (command == "recv") return run_receiver(argv[2], argv[3]);
+        print_help();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 1;
+}
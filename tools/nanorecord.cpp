@@ -0,0 +1,81 @@
+#include "nanobroker/Recorder.hpp"
+#include "nanobroker/video_protocol.hpp"
+#include <csignal>
+#include <iostream>
+#include <string>
+
+using FrameRecorder = NanoBroker::Recorder<Protocol::CameraFrame, Protocol::BUFFER_SIZE, Protocol::MAX_CONSUMERS>;
+using FrameReplayer = NanoBroker::Replayer<Protocol::CameraFrame, Protocol::BUFFER_SIZE, Protocol::MAX_CONSUMERS>;
+
+std::atomic<bool> running{true};
+
+void stop(int) { running = false; }
+
+void print_help() {
+    std::cout << "Usage: nanorecord <command> [args]\n"
+              << "Commands:\n"
+              << "  record <file> [topic] [seconds]  Record CameraFrames until Ctrl-C (or for seconds)\n"
+              << "  replay <file> [topic] [speed]    Republish a recording (speed 1 = recorded pace, 0 = max)\n"
+              << "  info <file>                      Show what a recording holds\n"
+              << "topic defaults to " << Protocol::TOPIC_NAME << "\n";
+}
+
+int record(const std::string &file, const std::string &topic, int seconds) {
+    NanoBroker::BrokerSettings settings;
+    settings.wait_strategy = NanoBroker::WaitStrategy::FUTEX;
+    FrameRecorder recorder(topic, file, NanoBroker::AUTO_ID, settings);
+    std::cout << "Recording " << topic << " as consumer " << recorder.id() << " to " << file << std::endl;
+
+    int64_t deadline = NanoBroker::detail::now_ns() + seconds * 1000000000ll;
+    while (running && (seconds <= 0 || NanoBroker::detail::now_ns() < deadline)) {
+        recorder.wait_and_pump(100);
+    }
+    std::cout << "Recorded " << recorder.entries() << " frames, "
+              << recorder.bytes_written() / (1024 * 1024) << " MB" << std::endl;
+    return 0;
+}
+
+int replay(const std::string &file, const std::string &topic, double speed) {
+    FrameReplayer replayer(file, topic);
+    std::cout << "Replaying " << replayer.size() << " frames from " << file << " to " << topic << std::endl;
+    size_t published = replayer.play(speed, &running);
+    std::cout << "Published " << published << " frames" << std::endl;
+    return replayer.at_end() ? 0 : 1;
+}
+
+int info(const std::string &file) {
+    NanoBroker::Recording recording(file);
+    const NanoBroker::RecordingHeader &h = recording.header();
+    double seconds = recording.size() ? recording.offset_ns(recording.size() - 1) / 1e9 : 0;
+
+    std::cout << "Topic: " << h.topic.c_str() << " | Frame struct: " << h.struct_size << " bytes" << std::endl;
+    std::cout << "Frames: " << h.entries << " | Data: " << (h.data_end - NanoBroker::detail::RECORDING_DATA_OFFSET) / (1024 * 1024)
+              << " MB | Duration: " << seconds << " s";
+    if (seconds > 0) std::cout << " | " << (recording.size() - 1) / seconds << " fps";
+    std::cout << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        print_help();
+        return 1;
+    }
+
+    std::string command = argv[1];
+    std::string file = argv[2];
+    std::string topic = (argc >= 4) ? argv[3] : Protocol::TOPIC_NAME;
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    try {
+        if (command == "record") return record(file, topic, (argc >= 5) ? std::stoi(argv[4]) : 0);
+        if (command == "replay") return replay(file, topic, (argc >= 5) ? std::stod(argv[4]) : 1.0);
+        if (command == "info") return info(file);
+        print_help();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 1;
+}